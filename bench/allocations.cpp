@@ -0,0 +1,126 @@
+#include "allocations.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+#include <stdlib.h>
+
+namespace
+{
+
+std::atomic<std::size_t> count{0};
+std::atomic<std::size_t> bytes{0};
+std::atomic<std::size_t> live{0};
+std::atomic<std::size_t> peak{0};
+std::atomic<std::size_t> baseline{0};
+
+void * allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+{
+  void * result = nullptr;
+  if (alignment <= alignof(std::max_align_t))
+    result = std::malloc(size == 0 ? 1 : size);
+  else if (posix_memalign(&result, alignment, size == 0 ? 1 : size) != 0)
+    result = nullptr;
+  if (result == nullptr)
+    throw std::bad_alloc{};
+  auto const usable = malloc_usable_size(result);
+  count.fetch_add(1, std::memory_order_relaxed);
+  bytes.fetch_add(usable, std::memory_order_relaxed);
+  auto const now = live.fetch_add(usable, std::memory_order_relaxed) + usable;
+  auto previous = peak.load(std::memory_order_relaxed);
+  while (now > previous && !peak.compare_exchange_weak(previous, now, std::memory_order_relaxed))
+  {
+  }
+  return result;
+}
+
+void deallocate(void * pointer)
+{
+  if (pointer == nullptr)
+    return;
+  live.fetch_sub(malloc_usable_size(pointer), std::memory_order_relaxed);
+  std::free(pointer);
+}
+
+} // namespace
+
+void * operator new(std::size_t size)
+{
+  return allocate(size);
+}
+
+void * operator new[](std::size_t size)
+{
+  return allocate(size);
+}
+
+void operator delete(void * pointer) noexcept
+{
+  deallocate(pointer);
+}
+
+void operator delete[](void * pointer) noexcept
+{
+  deallocate(pointer);
+}
+
+void operator delete(void * pointer, std::size_t) noexcept
+{
+  deallocate(pointer);
+}
+
+void operator delete[](void * pointer, std::size_t) noexcept
+{
+  deallocate(pointer);
+}
+
+// std::pmr::new_delete_resource allocates through the aligned overloads
+
+void * operator new(std::size_t size, std::align_val_t alignment)
+{
+  return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void * operator new[](std::size_t size, std::align_val_t alignment)
+{
+  return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void * pointer, std::align_val_t) noexcept
+{
+  deallocate(pointer);
+}
+
+void operator delete[](void * pointer, std::align_val_t) noexcept
+{
+  deallocate(pointer);
+}
+
+void operator delete(void * pointer, std::size_t, std::align_val_t) noexcept
+{
+  deallocate(pointer);
+}
+
+void operator delete[](void * pointer, std::size_t, std::align_val_t) noexcept
+{
+  deallocate(pointer);
+}
+
+namespace bench
+{
+
+void reset_allocations()
+{
+  count = 0;
+  bytes = 0;
+  baseline = live.load();
+  peak = baseline.load();
+}
+
+Allocations allocations()
+{
+  return {count.load(), bytes.load(), peak.load() - baseline.load()};
+}
+
+} // namespace bench
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+
+namespace bench
+{
+
+/*
+ * Heap usage seen by the global operator new and delete of the benchmark,
+ * since the last reset. Shared by the benchmarks of all modules, which link
+ * allocations.cpp to replace the global allocation functions.
+ */
+struct Allocations
+{
+  std::size_t count;
+  std::size_t bytes;
+  std::size_t peak_bytes; // largest amount live at once, above what was live at reset
+};
+
+void reset_allocations();
+
+Allocations allocations();
+
+} // namespace bench
@@ -0,0 +1,498 @@
+#include "allocations.hpp"
+#include "bit_islands.hpp"
+#include "bit_matrix.hpp"
+#include "dynamic_matrix.hpp"
+#include "island_counter.hpp"
+#include "island_index.hpp"
+#include "islands.hpp"
+#include "label_islands.hpp"
+#include "mmap_matrix.hpp"
+#include "parallel_islands.hpp"
+#include "scanline_islands.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <linux/perf_event.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <utility>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+using namespace islands;
+
+using Raster = DynamicMatrix<int>;
+
+/*
+ * Results are printed one per line as tab separated suite, case, engine,
+ * metric and value, so that runs can be diffed or joined on the first four.
+ */
+void report(char const * suite, std::string const & name, std::string const & engine, char const * metric,
+            double value)
+{
+  std::printf("%s\t%s\t%s\t%s\t%.4g\n", suite, name.c_str(), engine.c_str(), metric, value);
+}
+
+// xorshift, so that rasters are the same on every run
+struct Random
+{
+  std::uint64_t operator()()
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+
+  std::uint64_t state = 0x9e3779b97f4a7c15u;
+};
+
+// independent cells with given number of values, mostly small islands
+Raster noise(std::size_t size, unsigned values)
+{
+  Random random;
+  Raster result{std::vector<int>(size * size), size, size};
+  for (auto & cell : result.storage)
+    cell = static_cast<int>(random() % values);
+  return result;
+}
+
+// squares of 32x32 cells of three values, with a tenth of the cells flipped
+Raster blobs(std::size_t size)
+{
+  Random random;
+  Raster result{std::vector<int>(size * size), size, size};
+  for (std::size_t row = 0; row < size; ++row)
+    for (std::size_t col = 0; col < size; ++col)
+      result(row, col) = static_cast<int>(((row / 32) * 7 + (col / 32) * 13) % 3);
+  for (auto & cell : result.storage)
+    if (random() % 10 == 0)
+      cell = static_cast<int>(random() % 3);
+  return result;
+}
+
+// squares of side by side cells alternating between 0 and 1, a binary mask
+// of large uniform areas
+BitMatrix squares(std::size_t size, std::size_t side)
+{
+  BitMatrix result{size, size};
+  for (std::size_t row = 0; row < size; ++row)
+    for (std::size_t col = 0; col < size; ++col)
+      result.set(row, col, (row / side + col / side) % 2 == 1);
+  return result;
+}
+
+// zeros winding through the whole raster as one island, crossing every band
+// border, between lines of ones
+Raster snake(std::size_t size)
+{
+  Raster result{std::vector<int>(size * size, 0), size, size};
+  for (std::size_t col = 1; col < size; col += 2)
+    for (std::size_t row = 0; row < size; ++row)
+      result(row, col) = row != (col % 4 == 1 ? size - 1 : 0);
+  return result;
+}
+
+struct Measurement
+{
+  double ns_per_op;
+  int islands;
+};
+
+// repeats op for at least 200ms
+template <typename Op>
+Measurement measure(Op && op)
+{
+  using Clock = std::chrono::steady_clock;
+  std::size_t repetitions = 0;
+  int islands = 0;
+  auto const start = Clock::now();
+  auto now = start;
+  while (repetitions == 0 || now - start < std::chrono::milliseconds{200})
+  {
+    islands = op();
+    ++repetitions;
+    now = Clock::now();
+  }
+  std::chrono::duration<double, std::nano> const elapsed = now - start;
+  return {elapsed.count() / static_cast<double>(repetitions), islands};
+}
+
+// like measure, but op consumes a fresh copy of the input, made untimed
+template <typename Op>
+Measurement measure_on_copy(Raster const & input, Op && op)
+{
+  using Clock = std::chrono::steady_clock;
+  std::size_t repetitions = 0;
+  int islands = 0;
+  std::chrono::duration<double, std::nano> elapsed{0};
+  while (repetitions == 0 || elapsed < std::chrono::milliseconds{200})
+  {
+    auto copy = input;
+    auto const start = Clock::now();
+    islands = op(copy);
+    elapsed += Clock::now() - start;
+    ++repetitions;
+  }
+  return {elapsed.count() / static_cast<double>(repetitions), islands};
+}
+
+/*
+ * Hardware cache misses of the calling thread, counted where the kernel
+ * exposes them (usually not in virtual machines).
+ */
+class CacheMisses
+{
+public:
+  CacheMisses()
+  {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+  ~CacheMisses()
+  {
+    if (fd >= 0)
+      close(fd);
+  }
+  CacheMisses(CacheMisses const &) = delete;
+  CacheMisses & operator=(CacheMisses const &) = delete;
+
+  bool available() const
+  {
+    return fd >= 0;
+  }
+
+  template <typename Op>
+  double count(Op && op) const
+  {
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    op();
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    std::uint64_t result = 0;
+    if (read(fd, &result, sizeof(result)) != sizeof(result))
+      return 0;
+    return static_cast<double>(result);
+  }
+
+private:
+  int fd;
+};
+
+/*
+ * Throughput, and cache misses if available, of single threaded engines.
+ * Returns whether the engine counted expected islands.
+ */
+template <typename Engine>
+bool bench_engine(std::string const & name, char const * engine, Raster const & input, int expected,
+                  CacheMisses const & cache_misses)
+{
+  auto const cells = static_cast<double>(input.rows() * input.cols());
+  auto const measurement = measure([&] { return get_number_of_islands<Engine>(input); });
+  report("engines", name, engine, "ns_per_cell", measurement.ns_per_op / cells);
+  if (cache_misses.available())
+  {
+    auto const misses = cache_misses.count([&] { return get_number_of_islands<Engine>(input); });
+    report("engines", name, engine, "cache_misses_per_cell", misses / cells);
+  }
+  return measurement.islands == expected;
+}
+
+bool engines_suite(std::string const & name, Raster const & input, int expected)
+{
+  static CacheMisses const cache_misses;
+  report("engines", name, "-", "islands", expected);
+  bool result = true;
+  result &= bench_engine<FloodFill>(name, "flood_fill", input, expected, cache_misses);
+  result &= bench_engine<Scanline>(name, "scanline", input, expected, cache_misses);
+  auto const labeled = measure([&] { return static_cast<int>(label_islands(input).islands.size()); });
+  report("engines", name, "label_islands", "ns_per_cell",
+         labeled.ns_per_op / static_cast<double>(input.rows() * input.cols()));
+  result &= labeled.islands == expected;
+  auto const streaming = measure([&] {
+    IslandCounter<int> counter{input.cols()};
+    for (std::size_t row = 0; row < input.rows(); ++row)
+      counter.push_row(&input.storage[row * input.cols()]);
+    return counter.count();
+  });
+  report("engines", name, "streaming", "ns_per_cell",
+         streaming.ns_per_op / static_cast<double>(input.rows() * input.cols()));
+  result &= streaming.islands == expected;
+  auto const in_place = measure_on_copy(input, [](Raster & copy) { return get_number_of_islands_in_place(copy, -1); });
+  report("engines", name, "flood_fill_in_place", "ns_per_cell",
+         in_place.ns_per_op / static_cast<double>(input.rows() * input.cols()));
+  result &= in_place.islands == expected;
+  return result;
+}
+
+/*
+ * Throughput of flood fill and scanline specialized for each connectivity and
+ * predicate, the four connected equality ones are in the engines suite.
+ * Returns whether eight connected engines agree on the number of islands.
+ */
+bool connectivity_suite(std::string const & name, Raster const & input)
+{
+  auto const cells = static_cast<double>(input.rows() * input.cols());
+  auto const bench = [&](char const * engine_name, auto const & engine) {
+    auto const measurement = measure([&] { return get_number_of_islands(input, engine); });
+    report("connectivity", name, engine_name, "ns_per_cell", measurement.ns_per_op / cells);
+    report("connectivity", name, engine_name, "islands", measurement.islands);
+    return measurement.islands;
+  };
+  auto const flood_fill = bench("flood_fill_8", BasicFloodFill<EightConnected>{});
+  auto const scanline = bench("scanline_8", BasicScanline<EightConnected>{});
+  bench("flood_fill_4_tolerance", BasicFloodFill<FourConnected, WithinTolerance<int>>{{1}});
+  bench("flood_fill_8_tolerance", BasicFloodFill<EightConnected, WithinTolerance<int>>{{1}});
+  return flood_fill == scanline;
+}
+
+/*
+ * Cost of keeping the count of an IslandIndex up to date under batches of
+ * random updates, setting cells to values of other random cells, compared to
+ * counting anew with the scanline after each batch. Returns whether the
+ * index counts as many islands as the scanline at the end.
+ */
+bool updates_suite(std::string const & name, Raster const & input, int expected)
+{
+  constexpr std::size_t batch = 4096;
+  auto const cells = input.rows() * input.cols();
+  auto const build = measure([&] { return static_cast<int>(IslandIndex<int>{input}.count()); });
+  report("updates", name, "island_index", "build_ns_per_cell", build.ns_per_op / static_cast<double>(cells));
+  IslandIndex<int> index{input};
+  Random random;
+  std::vector<IslandIndex<int>::Update> updates(batch);
+  auto const applied = measure([&] {
+    for (auto & update : updates)
+    {
+      auto const cell = random() % cells;
+      update = {cell / input.cols(), cell % input.cols(), input.storage[random() % cells]};
+    }
+    index.set(updates);
+    return static_cast<int>(index.count());
+  });
+  report("updates", name, "island_index", "ns_per_update", applied.ns_per_op / batch);
+  // a batch labels anew rather than cost much more than that
+  report("updates", name, "island_index", "batch_over_build", applied.ns_per_op / build.ns_per_op);
+  auto const recount = measure([&] { return get_number_of_islands<Scanline>(index.matrix()); });
+  report("updates", name, "island_index", "speedup_over_recount", recount.ns_per_op / applied.ns_per_op);
+  return build.islands == expected && applied.islands == recount.islands;
+}
+
+/*
+ * BitScanline on bits against Scanline, measured by the caller, and against
+ * only reading every word of bits, which bounds the speed of any count.
+ * Returns whether both engines counted the same.
+ */
+bool bench_bit_scanline(std::string const & name, BitMatrix const & bits, Measurement const & scanline)
+{
+  auto const cells = static_cast<double>(bits.rows() * bits.cols());
+  auto const bytes = static_cast<double>(bits.rows() * bits.words_per_row() * sizeof(std::uint64_t));
+  auto const bit_scanline = measure([&] { return get_number_of_islands<BitScanline>(bits); });
+  report("binary", name, "bit_scanline", "ns_per_cell", bit_scanline.ns_per_op / cells);
+  report("binary", name, "bit_scanline", "gb_per_s", bytes / bit_scanline.ns_per_op);
+  report("binary", name, "bit_scanline", "speedup", scanline.ns_per_op / bit_scanline.ns_per_op);
+  auto const read = measure([&] {
+    std::uint64_t sum = 0;
+    for (std::size_t row = 0; row < bits.rows(); ++row)
+      for (std::size_t word = 0; word < bits.words_per_row(); ++word)
+        sum += bits.row(row)[word];
+    // keeps the compiler from reading only once for all repetitions
+    asm volatile("" : : "r"(sum) : "memory");
+    return static_cast<int>(sum % 2);
+  });
+  report("binary", name, "read", "gb_per_s", bytes / read.ns_per_op);
+  report("binary", name, "bit_scanline", "speed_over_read", read.ns_per_op / bit_scanline.ns_per_op);
+  return scanline.islands == bit_scanline.islands;
+}
+
+/*
+ * Counting islands of a binary mask of the raster, odd cells being 1, kept
+ * as ints or packed in a BitMatrix. Returns whether both counted the same.
+ */
+bool binary_suite(std::string const & name, Raster const & input)
+{
+  auto mask = input;
+  for (auto & cell : mask.storage)
+    cell %= 2;
+  auto const cells = static_cast<double>(input.rows() * input.cols());
+  auto const scanline = measure([&] { return get_number_of_islands<Scanline>(mask); });
+  report("binary", name, "scanline", "ns_per_cell", scanline.ns_per_op / cells);
+  return bench_bit_scanline(name, BitMatrix{mask}, scanline);
+}
+
+/*
+ * Counting islands of a mask only ever packed in a BitMatrix, with Scanline
+ * reading it a cell at a time. Returns whether both counted the same.
+ */
+bool binary_suite(std::string const & name, BitMatrix const & bits)
+{
+  auto const scanline = measure([&] { return get_number_of_islands<Scanline>(bits); });
+  report("binary", name, "scanline", "ns_per_cell", scanline.ns_per_op / static_cast<double>(bits.rows() * bits.cols()));
+  return bench_bit_scanline(name, bits, scanline);
+}
+
+// square part of a raster, as a matrix of its own
+struct Tile
+{
+  int operator()(std::size_t row, std::size_t col) const
+  {
+    return raster(first_row + row, first_col + col);
+  }
+
+  std::size_t rows() const
+  {
+    return size;
+  }
+
+  std::size_t cols() const
+  {
+    return size;
+  }
+
+  Raster const & raster;
+  std::size_t first_row;
+  std::size_t first_col;
+  std::size_t size;
+};
+
+/*
+ * Counting islands of each 64 by 64 tile of the raster with the flood fill,
+ * allocating its buffers on each call or reusing a workspace. Returns whether
+ * both counted the same.
+ */
+bool tiles_suite(std::string const & name, Raster const & input)
+{
+  constexpr std::size_t size = 64;
+  auto const tiles = (input.rows() / size) * (input.cols() / size);
+  auto const count_tiles = [&](auto const & count) {
+    int result = 0;
+    for (std::size_t row = 0; row + size <= input.rows(); row += size)
+      for (std::size_t col = 0; col + size <= input.cols(); col += size)
+        result += count(Tile{input, row, col, size});
+    return result;
+  };
+  IslandsWorkspace workspace;
+  auto const fresh = [](Tile const & tile) { return get_number_of_islands(tile); };
+  auto const reused = [&](Tile const & tile) { return get_number_of_islands(tile, workspace); };
+  auto const allocations_per_tile = [&](auto const & count) {
+    bench::reset_allocations();
+    count_tiles(count);
+    return static_cast<double>(bench::allocations().count) / static_cast<double>(tiles);
+  };
+  auto const allocating = measure([&] { return count_tiles(fresh); });
+  report("tiles", name, "flood_fill", "ns_per_tile", allocating.ns_per_op / static_cast<double>(tiles));
+  report("tiles", name, "flood_fill", "allocations_per_tile", allocations_per_tile(fresh));
+  auto const reusing = measure([&] { return count_tiles(reused); });
+  report("tiles", name, "flood_fill_workspace", "ns_per_tile", reusing.ns_per_op / static_cast<double>(tiles));
+  report("tiles", name, "flood_fill_workspace", "allocations_per_tile", allocations_per_tile(reused));
+  return allocating.islands == reusing.islands;
+}
+
+/*
+ * Throughput of parallel labeling on 1, 2, 4... up to all cores, and its
+ * speedup over a single thread. Returns whether all counted expected islands.
+ */
+bool scaling_suite(std::string const & name, Raster const & input, int expected)
+{
+  auto const cells = static_cast<double>(input.rows() * input.cols());
+  auto const cores = std::max(1u, std::thread::hardware_concurrency());
+  bool result = true;
+  double single = 0;
+  for (unsigned threads = 1; threads <= cores; threads = threads < cores && threads * 2 > cores ? cores : threads * 2)
+  {
+    auto const parallel = measure([&] { return get_number_of_islands(input, Parallel{threads}); });
+    if (threads == 1)
+      single = parallel.ns_per_op;
+    auto const engine = "parallel_x" + std::to_string(threads);
+    report("scaling", name, engine, "ns_per_cell", parallel.ns_per_op / cells);
+    report("scaling", name, engine, "speedup", single / parallel.ns_per_op);
+    result &= parallel.islands == expected;
+    if (threads == cores)
+      break;
+  }
+  return result;
+}
+
+/*
+ * Counting islands of a raster kept in a file, read whole into memory first
+ * or mapped. Returns whether both counted expected islands.
+ */
+bool file_suite(std::string const & name, Raster const & input, int expected)
+{
+  auto const path = (std::filesystem::temp_directory_path() / "islands_bench_raster.bin").string();
+  MatrixFile::write(path.c_str(), input);
+  auto const cells = static_cast<double>(input.rows() * input.cols());
+  auto const read = measure([&] {
+    MatrixFile::Header header;
+    auto const file = std::fopen(path.c_str(), "rb");
+    Raster loaded{{}, 0, 0};
+    if (file != nullptr && std::fread(&header, sizeof(header), 1, file) == 1)
+    {
+      loaded = Raster{std::vector<int>(header.rows * header.cols), header.rows, header.cols};
+      if (std::fread(loaded.storage.data(), sizeof(int), loaded.storage.size(), file) != loaded.storage.size())
+        loaded = Raster{{}, 0, 0};
+    }
+    if (file != nullptr)
+      std::fclose(file);
+    return get_number_of_islands<Scanline>(loaded);
+  });
+  report("file", name, "read_scanline", "ns_per_cell", read.ns_per_op / cells);
+  auto const mapped = measure([&] {
+    MmapMatrix<int> const raster{path.c_str(), MmapMatrix<int>::Access::Sequential};
+    return get_number_of_islands<Scanline>(raster);
+  });
+  report("file", name, "mmap_scanline", "ns_per_cell", mapped.ns_per_op / cells);
+  std::remove(path.c_str());
+  return read.islands == expected && mapped.islands == expected;
+}
+
+} // namespace
+
+/*
+ * Islands counting throughput of each engine on generated rasters. The exit
+ * status is 1 if engines disagree on the number of islands.
+ */
+int main()
+{
+  constexpr std::size_t size = 4096;
+  std::printf("suite\tcase\tengine\tmetric\tvalue\n");
+  std::pair<char const *, Raster> const rasters[] = {
+    {"noise/2", noise(size, 2)},
+    {"noise/8", noise(size, 8)},
+    {"blobs", blobs(size)},
+    {"snake", snake(size)},
+  };
+  bool result = true;
+  for (auto const & [name, raster] : rasters)
+  {
+    auto const expected = get_number_of_islands(raster);
+    result &= engines_suite(name, raster, expected);
+    result &= connectivity_suite(name, raster);
+    result &= updates_suite(name, raster, expected);
+    result &= binary_suite(name, raster);
+    result &= tiles_suite(name, raster);
+    result &= scaling_suite(name, raster, expected);
+    result &= file_suite(name, raster, expected);
+  }
+  // 32MB of bits, more than caches hold
+  result &= binary_suite("squares/1024", squares(4 * size, 1024));
+  if (!result)
+  {
+    std::fprintf(stderr, "engines disagree on the number of islands\n");
+    return 1;
+  }
+  return 0;
+}
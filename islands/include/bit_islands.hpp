@@ -0,0 +1,133 @@
+#pragma once
+
+#include "bit_matrix.hpp"
+#include "islands.hpp"
+#include "union_find.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace islands
+{
+
+namespace Details
+{
+
+// bits of cells in the last, partial word of a row
+inline std::uint64_t last_word_mask(std::size_t cols)
+{
+  return cols % 64 == 0 ? ~std::uint64_t{0} : (std::uint64_t{1} << (cols % 64)) - 1;
+}
+
+/*
+ * Runs of a row of a BitMatrix, as bits set at the first cell of each run.
+ * Cell 0 always starts one, others where they differ from the cell before.
+ * Runs are numbered from 0 in order of columns, the run of a cell is found by
+ * counting starts up to it: those in words before come from runs_before.
+ */
+struct RunStarts
+{
+  std::vector<std::uint64_t> starts;
+  std::vector<std::uint32_t> runs_before;
+  std::uint32_t runs = 0;
+
+  void assign(std::uint64_t const * cells, std::size_t words, std::uint64_t last_mask)
+  {
+    starts.resize(words);
+    runs_before.resize(words);
+    runs = 0;
+    // the cell before cell 0 taken as differing from it
+    auto carry = ~cells[0] & 1u;
+    for (std::size_t word = 0; word < words; ++word)
+    {
+      auto const shifted = cells[word] << 1 | carry;
+      carry = cells[word] >> 63;
+      starts[word] = (cells[word] ^ shifted) & (word + 1 == words ? last_mask : ~std::uint64_t{0});
+      runs_before[word] = runs;
+      // words of uniform areas start no run, skipping their popcount
+      if (starts[word] != 0)
+        runs += static_cast<std::uint32_t>(__builtin_popcountll(starts[word]));
+    }
+  }
+
+  // number of the run holding cell bit of word
+  std::uint32_t run_of(std::size_t word, unsigned bit) const
+  {
+    auto const up_to_bit = starts[word] & (~std::uint64_t{0} >> (63 - bit));
+    return runs_before[word] + static_cast<std::uint32_t>(__builtin_popcountll(up_to_bit)) - 1;
+  }
+};
+
+} // namespace Details
+
+/*
+ * Counts islands of both 0 and 1 cells of a BitMatrix, like Scanline, but
+ * never looking at cells one by one. Run starts of a row are the bits where
+ * a word differs from itself shifted by a cell. A run touches a run of the
+ * row above with the same value where both rows are equal, so equal runs
+ * meet once at each start of a stretch of equal cells and at each run start
+ * within one. Those contacts are found by ctz, and the runs holding them by
+ * popcount of run starts. A run continuing a single run above takes its
+ * label, so the union-find only grows with islands started, not with runs.
+ * Work is a few operations per word plus some per contact, and rows equal to
+ * the one above are skipped once compared, so large uniform areas go at
+ * memory bandwidth.
+ */
+struct BitScanline
+{
+  int operator()(BitMatrix const & input) const
+  {
+    if (input.rows() == 0 || input.cols() == 0)
+      return 0;
+    constexpr auto unlabeled = ~std::uint32_t{0};
+    auto const words = input.words_per_row();
+    auto const last_mask = Details::last_word_mask(input.cols());
+    UnionFind labels;
+    Details::RunStarts above;
+    Details::RunStarts runs;
+    std::vector<std::uint32_t> above_labels;
+    std::vector<std::uint32_t> run_labels;
+    std::size_t merged = 0;
+    for (std::size_t row = 0; row < input.rows(); ++row)
+    {
+      // a row equal to the one above has its runs, each continuing the
+      // island of the run above, so runs and labels above stay as they are
+      if (row > 0 && std::equal(input.row(row), input.row(row) + words, input.row(row - 1)))
+        continue;
+      runs.assign(input.row(row), words, last_mask);
+      run_labels.assign(runs.runs, unlabeled);
+      if (row > 0)
+      {
+        auto const cells = input.row(row);
+        auto const cells_above = input.row(row - 1);
+        std::uint64_t carry = 0;
+        for (std::size_t word = 0; word < words; ++word)
+        {
+          auto const equal = ~(cells[word] ^ cells_above[word]) & (word + 1 == words ? last_mask : ~std::uint64_t{0});
+          auto contacts = equal & (~(equal << 1 | carry) | runs.starts[word]);
+          carry = equal >> 63;
+          for (; contacts != 0; contacts &= contacts - 1)
+          {
+            auto const bit = static_cast<unsigned>(__builtin_ctzll(contacts));
+            auto & label = run_labels[runs.run_of(word, bit)];
+            auto const touching = above_labels[above.run_of(word, bit)];
+            // a run continues the island of the first run it touches, others
+            // are merged into it
+            if (label == unlabeled)
+              label = touching;
+            else if (labels.unite(label, touching))
+              ++merged;
+          }
+        }
+      }
+      for (auto & label : run_labels)
+        if (label == unlabeled)
+          label = labels.add();
+      std::swap(above, runs);
+      std::swap(above_labels, run_labels);
+    }
+    return Details::island_count(labels.size() - merged);
+  }
+};
+
+} // namespace islands
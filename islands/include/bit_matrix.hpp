@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace islands
+{
+
+/*
+ * Matrix of 0/1 cells packed 64 per word, each row starting at a new word.
+ * Cell col of a row is bit col % 64 of its word col / 64, bits past the last
+ * column are kept 0. Usable with every engine, BitScanline counts its islands
+ * a word at a time.
+ */
+class BitMatrix
+{
+public:
+  BitMatrix(std::size_t rows, std::size_t cols)
+  : words((cols + 63) / 64 * rows, 0)
+  , rows_{rows}
+  , cols_{cols}
+  {}
+
+  // cells of input not equal to 0 are 1
+  template <typename Matrix>
+  explicit BitMatrix(Matrix const & input)
+  : BitMatrix(input.rows(), input.cols())
+  {
+    for (std::size_t row = 0; row < rows_; ++row)
+      for (std::size_t col = 0; col < cols_; ++col)
+        if (input(row, col) != 0)
+          set(row, col, true);
+  }
+
+  bool operator()(std::size_t row, std::size_t col) const
+  {
+    return (words[row * words_per_row() + col / 64] >> (col % 64)) & 1u;
+  }
+
+  void set(std::size_t row, std::size_t col, bool value)
+  {
+    auto & word = words[row * words_per_row() + col / 64];
+    auto const bit = std::uint64_t{1} << (col % 64);
+    word = value ? word | bit : word & ~bit;
+  }
+
+  // words_per_row() words holding cells of a row
+  std::uint64_t const * row(std::size_t row) const
+  {
+    return words.data() + row * words_per_row();
+  }
+
+  std::size_t words_per_row() const
+  {
+    return (cols_ + 63) / 64;
+  }
+
+  std::size_t rows() const
+  {
+    return rows_;
+  }
+
+  std::size_t cols() const
+  {
+    return cols_;
+  }
+
+private:
+  std::vector<std::uint64_t> words;
+  std::size_t rows_;
+  std::size_t cols_;
+};
+
+} // namespace islands
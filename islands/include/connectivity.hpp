@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace islands
+{
+
+/*
+ * Connectivity policies, neighbours of a cell as row and column offsets.
+ * Cells sharing an edge are connected in both, those sharing a corner only
+ * in EightConnected.
+ */
+struct FourConnected
+{
+  static constexpr bool diagonal = false;
+  static constexpr std::array<std::pair<std::ptrdiff_t, std::ptrdiff_t>, 4> neighbours{{
+    {-1, 0}, {0, -1}, {0, 1}, {1, 0}}};
+};
+
+struct EightConnected
+{
+  static constexpr bool diagonal = true;
+  static constexpr std::array<std::pair<std::ptrdiff_t, std::ptrdiff_t>, 8> neighbours{{
+    {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}}};
+};
+
+/*
+ * Predicate connecting neighbouring cells differing by at most tolerance,
+ * an alternative to std::equal_to. Not transitive: an island may hold cells
+ * differing by more, as long as they are linked by cells in between.
+ */
+template <typename T>
+struct WithinTolerance
+{
+  T tolerance;
+
+  bool operator()(T const & a, T const & b) const
+  {
+    return a < b ? b - a <= tolerance : a - b <= tolerance;
+  }
+};
+
+} // namespace islands
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "scanline_islands.hpp"
+#include "union_find.hpp"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace islands
+{
+
+/*
+ * Counts islands of a matrix given one row at a time, top to bottom, so that
+ * the matrix never has to be kept whole. Only runs of the last row are kept,
+ * labeled with the islands they belong to, and an island is counted once a
+ * row doesn't touch it anymore, so memory use is O(cols).
+ */
+template <typename T>
+class IslandCounter
+{
+public:
+  explicit IslandCounter(std::size_t cols)
+  : cols_{cols}
+  {}
+
+  // consumes the next row, of cols() cells
+  void push_row(T const * row)
+  {
+    if (cols_ == 0)
+      return;
+    auto const above_islands = static_cast<std::uint32_t>(open);
+    labels.clear();
+    for (std::uint32_t island = 0; island < above_islands; ++island)
+      labels.add();
+    Details::extract_runs(cols_, [row](std::size_t col) { return row[col]; }, runs, labels);
+    if (!above.empty())
+      Details::connect_runs(above, runs, labels);
+
+    renumbered.assign(labels.size(), unnumbered);
+    open = 0;
+    for (auto & run : runs)
+    {
+      auto & island = renumbered[labels.find(run.label)];
+      if (island == unnumbered)
+        island = static_cast<std::uint32_t>(open++);
+      run.label = island;
+    }
+    // islands of the row above not continued in this one are complete
+    for (std::uint32_t island = 0; island < above_islands; ++island)
+      if (renumbered[labels.find(island)] == unnumbered)
+        ++closed;
+    std::swap(above, runs);
+  }
+
+  // islands in the rows pushed so far
+  int count() const
+  {
+    return Details::island_count(closed + open);
+  }
+
+  std::size_t cols() const
+  {
+    return cols_;
+  }
+
+  // forgets the rows pushed so far
+  void reset()
+  {
+    above.clear();
+    closed = 0;
+    open = 0;
+  }
+
+private:
+  static constexpr std::uint32_t unnumbered = std::numeric_limits<std::uint32_t>::max();
+
+  std::size_t cols_;
+  // runs of the last row, labeled with islands numbered from 0 to open - 1
+  std::vector<Details::Run<T>> above;
+  std::vector<Details::Run<T>> runs;
+  UnionFind labels; // islands of the row above, then runs of the new row
+  std::vector<std::uint32_t> renumbered;
+  std::size_t closed = 0;
+  std::size_t open = 0;
+};
+
+} // namespace islands
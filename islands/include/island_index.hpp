@@ -0,0 +1,309 @@
+#pragma once
+
+#include "connectivity.hpp"
+#include "dynamic_matrix.hpp"
+#include "scanline_islands.hpp"
+#include "union_find.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace islands
+{
+
+/*
+ * Islands of a matrix of cells updated in place, counted without going over
+ * the whole matrix again. Every cell is labeled with a union-find element,
+ * cells of an island having the same root. A cell joining neighbouring islands
+ * unites them. A cell leaving an island whose other cells it touches at
+ * several places may split it: searches started from each of those places
+ * in lockstep stop once all but one of them either met or ran out of cells,
+ * only the pieces that ran out get new labels. So an update costs time
+ * proportional to the smaller pieces of the island it splits.
+ * Cells of an island are equal and connected as given by Connectivity.
+ */
+template <typename T, typename Connectivity = FourConnected>
+class IslandIndex
+{
+public:
+  struct Update
+  {
+    std::size_t row;
+    std::size_t col;
+    T value;
+  };
+
+  template <typename Matrix>
+  explicit IslandIndex(Matrix const & input)
+  : cells{std::vector<T>(input.rows() * input.cols()), input.rows(), input.cols()}
+  , label(cells.storage.size())
+  , seen(cells.storage.size(), 0)
+  , seen_by(cells.storage.size())
+  {
+    for (std::size_t row = 0; row < rows(); ++row)
+      for (std::size_t col = 0; col < cols(); ++col)
+        cells(row, col) = input(row, col);
+    relabel();
+  }
+
+  // number of islands, kept up to date by every set
+  std::size_t count() const
+  {
+    return islands;
+  }
+
+  void set(std::size_t row, std::size_t col, T const & value)
+  {
+    auto const cell = row * cols() + col;
+    T const old = cells.storage[cell];
+    if (old == value)
+      return;
+    cells.storage[cell] = value;
+    leave(row, col, old);
+    join(row, col, value);
+    // labels of split off pieces are never reused, start over before they
+    // outnumber cells
+    if (labels.size() > 2 * cells.storage.size() + 64)
+      relabel();
+  }
+
+  // applies a batch of updates, a range of Update or of other row, col and
+  // value triples. Splits of large islands may need searches through many
+  // cells, each costing search_cost times labeling one anew, so once those
+  // add up to a quarter of labeling the whole matrix, searches stop, the
+  // remaining updates are just stored and all cells labeled anew. A batch
+  // costs at most about one labeling of the matrix besides its updates.
+  template <typename Updates>
+  void set(Updates const & updates)
+  {
+    searched = 0;
+    search_budget = cells.storage.size() / (4 * search_cost);
+    over_budget = false;
+    for (auto const & [row, col, value] : updates)
+    {
+      if (over_budget)
+        cells(row, col) = value;
+      else
+        set(row, col, value);
+    }
+    search_budget = std::numeric_limits<std::size_t>::max();
+    if (over_budget)
+      relabel();
+  }
+
+  // whether both cells are on the same island
+  bool connected(std::size_t row, std::size_t col, std::size_t other_row, std::size_t other_col)
+  {
+    return labels.find(label[row * cols() + col]) == labels.find(label[other_row * cols() + other_col]);
+  }
+
+  T const & operator()(std::size_t row, std::size_t col) const
+  {
+    return cells(row, col);
+  }
+
+  DynamicMatrix<T> const & matrix() const
+  {
+    return cells;
+  }
+
+  std::size_t rows() const
+  {
+    return cells.rows();
+  }
+
+  std::size_t cols() const
+  {
+    return cells.cols();
+  }
+
+private:
+  static constexpr std::size_t max_searches = Connectivity::neighbours.size();
+  // labeling cells anew costs about as much per this many cells as searching
+  // through one of them
+  static constexpr std::size_t search_cost = 2;
+
+  // cells reached by a search, also its queue from next on
+  struct Search
+  {
+    std::vector<std::size_t> reached;
+    std::size_t next = 0;
+    std::size_t group = 0;
+    bool done = false;
+  };
+
+  // labels all cells from scratch, a run of equal cells at a time
+  void relabel()
+  {
+    labels.clear();
+    islands = 0;
+    if (rows() == 0 || cols() == 0)
+      return;
+    std::vector<Details::Run<T>> above;
+    std::vector<Details::Run<T>> runs;
+    std::size_t merged = 0;
+    for (std::size_t row = 0; row < rows(); ++row)
+    {
+      Details::extract_runs(cols(), [&](std::size_t col) { return cells(row, col); }, runs, labels);
+      if (row > 0)
+        merged += Details::connect_runs<Connectivity>(above, runs, labels);
+      for (auto const & run : runs)
+        std::fill(label.begin() + row * cols() + run.begin, label.begin() + row * cols() + run.end, run.label);
+      std::swap(above, runs);
+    }
+    islands = labels.size() - merged;
+  }
+
+  // calls visit with the index of each neighbour of cell row, col inside
+  // the matrix
+  template <typename Visit>
+  void for_each_neighbour(std::size_t row, std::size_t col, Visit const & visit) const
+  {
+    for (auto const & [drow, dcol] : Connectivity::neighbours)
+    {
+      // negative offsets wrap around to values out of bounds
+      auto const nrow = row + static_cast<std::size_t>(drow);
+      auto const ncol = col + static_cast<std::size_t>(dcol);
+      if (nrow < rows() && ncol < cols())
+        visit(nrow * cols() + ncol);
+    }
+  }
+
+  // the cell at row, col, no longer equal to old, leaves its island
+  void leave(std::size_t row, std::size_t col, T const & old)
+  {
+    std::size_t starts = 0;
+    if (++epoch == 0)
+    {
+      std::fill(seen.begin(), seen.end(), 0);
+      epoch = 1;
+    }
+    for_each_neighbour(row, col, [&](std::size_t cell) {
+      if (cells.storage[cell] == old)
+      {
+        auto & search = searches[starts];
+        search.reached.assign(1, cell);
+        search.next = 0;
+        search.group = starts;
+        search.done = false;
+        seen[cell] = epoch;
+        seen_by[cell] = static_cast<std::uint8_t>(starts);
+        ++starts;
+      }
+    });
+    if (starts == 0)
+      --islands;
+    if (starts > 1)
+      split(old, starts);
+  }
+
+  // searches from starts neighbours of a cell which left an island, for
+  // pieces of the island they fall apart into
+  void split(T const & old, std::size_t starts)
+  {
+    auto groups = starts;
+    auto const merge = [&](std::size_t from, std::size_t into) {
+      for (std::size_t i = 0; i < starts; ++i)
+        if (searches[i].group == from)
+          searches[i].group = into;
+      --groups;
+    };
+    while (groups > 1)
+    {
+      // labels and count are left inconsistent, relabel makes them right
+      if (searched > search_budget)
+      {
+        over_budget = true;
+        return;
+      }
+      for (std::size_t i = 0; i < starts; ++i)
+      {
+        auto & search = searches[i];
+        if (search.done || search.next == search.reached.size())
+          continue;
+        auto const cell = search.reached[search.next++];
+        for_each_neighbour(cell / cols(), cell % cols(), [&](std::size_t neighbour) {
+          if (!(cells.storage[neighbour] == old))
+            return;
+          if (seen[neighbour] != epoch)
+          {
+            seen[neighbour] = epoch;
+            seen_by[neighbour] = static_cast<std::uint8_t>(i);
+            search.reached.push_back(neighbour);
+            ++searched;
+          }
+          else if (searches[seen_by[neighbour]].group != search.group)
+            merge(searches[seen_by[neighbour]].group, search.group);
+        });
+      }
+      // a group whose searches ran out of cells is a piece split off
+      for (std::size_t group = 0; group < starts && groups > 1; ++group)
+      {
+        bool exhausted = true;
+        bool found = false;
+        for (std::size_t i = 0; i < starts; ++i)
+          if (searches[i].group == group && !searches[i].done)
+          {
+            found = true;
+            exhausted &= searches[i].next == searches[i].reached.size();
+          }
+        if (!found || !exhausted)
+          continue;
+        auto const piece = labels.add();
+        for (std::size_t i = 0; i < starts; ++i)
+          if (searches[i].group == group)
+          {
+            searches[i].done = true;
+            for (auto const cell : searches[i].reached)
+              label[cell] = piece;
+          }
+        ++islands;
+        --groups;
+      }
+    }
+  }
+
+  // the cell at row, col, now equal to value, joins or unites neighbouring
+  // islands of that value
+  void join(std::size_t row, std::size_t col, T const & value)
+  {
+    auto const cell = row * cols() + col;
+    bool joined = false;
+    for_each_neighbour(row, col, [&](std::size_t neighbour) {
+      if (!(cells.storage[neighbour] == value))
+        return;
+      if (!joined)
+      {
+        label[cell] = labels.find(label[neighbour]);
+        joined = true;
+      }
+      else if (labels.unite(label[cell], label[neighbour]))
+        --islands;
+    });
+    if (!joined)
+    {
+      label[cell] = labels.add();
+      ++islands;
+    }
+  }
+
+  DynamicMatrix<T> cells;
+  std::vector<std::uint32_t> label;
+  UnionFind labels;
+  std::size_t islands = 0;
+  // cells reached by searches of the current split are seen in its epoch,
+  // by the search in seen_by
+  std::vector<std::uint32_t> seen;
+  std::vector<std::uint8_t> seen_by;
+  std::uint32_t epoch = 0;
+  std::array<Search, max_searches> searches;
+  // cells reached by searches of splits since the start of a batch, which
+  // is over budget once they are more than search_budget
+  std::size_t searched = 0;
+  std::size_t search_budget = std::numeric_limits<std::size_t>::max();
+  bool over_budget = false;
+};
+
+} // namespace islands
@@ -1,76 +1,225 @@
 #pragma once
 
+#include "connectivity.hpp"
 #include "dynamic_matrix.hpp"
-#include <queue>
+#include "visited_bits.hpp"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace islands
 {
 
+/*
+ * Buffers of the flood fill kept between calls: visited flags and the
+ * frontier, a stack of cells to visit by their index in the visited flags.
+ * Both grow to the size needed by the largest matrix counted and stay so,
+ * further calls don't allocate. Indices are packed in 32 bits as long as the
+ * matrix, with a border of one cell around, has at most 2^32 cells, larger
+ * ones use wide_frontier.
+ */
+struct IslandsWorkspace
+{
+  VisitedBits visited;
+  std::vector<std::uint32_t> frontier;
+  std::vector<std::size_t> wide_frontier;
+};
+
 namespace Details
 {
 
+// number of islands as returned by engines, throws std::overflow_error if it
+// doesn't fit in an int
+inline int island_count(std::size_t count)
+{
+  if (count > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+    throw std::overflow_error{"more islands than an int can count"};
+  return static_cast<int>(count);
+}
 
-using Index = std::pair<std::size_t, std::size_t>;
+/*
+ * Resets visited to flags of a rows by cols matrix framed by a border of
+ * cells marked visited, so that neighbours of any cell can be tested without
+ * bounds checks. Cell row, col has index (row + 1) * (cols + 2) + col + 1.
+ */
+inline void reset_padded(VisitedBits & visited, std::size_t rows, std::size_t cols)
+{
+  auto const stride = cols + 2;
+  visited.reset((rows + 2) * stride);
+  for (std::size_t col = 0; col < stride; ++col)
+  {
+    visited.set(col);
+    visited.set((rows + 1) * stride + col);
+  }
+  for (std::size_t row = 1; row <= rows; ++row)
+  {
+    visited.set(row * stride);
+    visited.set(row * stride + stride - 1);
+  }
+}
 
-template<typename Matrix>
-void add_to_queue_if_matches(Matrix const & input, std::queue<Index> & to_visit,
-                             DynamicMatrix<bool> const & visited,
-                             std::size_t row, std::size_t col,
-                             std::size_t nrow, std::size_t ncol)
+// cells are marked as visited once pushed, so that none is pushed twice;
+// border cells are never pushed, nor are they read from the input
+template <typename Connectivity, typename Equivalent, typename Matrix, typename Frontier>
+void visit(Matrix const & input, Equivalent const & equivalent, VisitedBits & visited, Frontier & frontier,
+           std::size_t start)
 {
-  if (!visited(nrow, ncol) && input(nrow, ncol) == input(row, col))
-    to_visit.emplace(nrow, ncol);
+  using T = std::decay_t<decltype(input(0, 0))>;
+  using PackedIndex = typename Frontier::value_type;
+  auto const stride = input.cols() + 2;
+  visited.set(start);
+  frontier.push_back(static_cast<PackedIndex>(start));
+  while (!frontier.empty())
+  {
+    std::size_t const cell = frontier.back();
+    frontier.pop_back();
+    auto const row = cell / stride - 1;
+    auto const col = cell % stride - 1;
+    T const value = input(row, col);
+    for (auto const & [drow, dcol] : Connectivity::neighbours)
+    {
+      // offsets are negative at most by one, wrapping around is undone by
+      // the additions
+      auto const neighbour = cell + static_cast<std::size_t>(drow) * stride + static_cast<std::size_t>(dcol);
+      if (!visited.test(neighbour)
+          && equivalent(input(row + static_cast<std::size_t>(drow), col + static_cast<std::size_t>(dcol)), value))
+      {
+        visited.set(neighbour);
+        frontier.push_back(static_cast<PackedIndex>(neighbour));
+      }
+    }
+  }
 }
 
-template <typename Matrix>
-void add_neighbours_to_queue(Matrix const & input, std::queue<Index> & to_visit,
-                             DynamicMatrix<bool> const & visited,
-                             std::size_t row, std::size_t col)
+// islands of input, visited flags reset by reset_padded, indices of which
+// must fit in the frontier's value type
+template <typename Connectivity, typename Equivalent, typename Matrix, typename Frontier>
+std::size_t flood_fill(Matrix const & input, Equivalent const & equivalent, VisitedBits & visited, Frontier & frontier)
 {
-  if (row > 0) add_to_queue_if_matches(input, to_visit, visited, row, col, row - 1, col);
-  if (col > 0) add_to_queue_if_matches(input, to_visit, visited, row, col, row, col - 1);
-  if (row < input.rows() - 1)
-    add_to_queue_if_matches(input, to_visit, visited, row, col, row + 1, col);
-  if (col < input.cols() - 1)
-    add_to_queue_if_matches(input, to_visit, visited, row, col, row, col + 1);
+  std::size_t result = 0;
+  for (auto cell = visited.next_unvisited(0); cell < visited.size(); cell = visited.next_unvisited(cell + 1))
+  {
+    ++result;
+    visit<Connectivity>(input, equivalent, visited, frontier, cell);
+  }
+
+  return result;
 }
 
-template <typename Matrix>
-void visit(Matrix const & input, DynamicMatrix<bool> & visited,
-           std::size_t row, std::size_t col)
+// flood fill overwriting cells equal to the one at start, of index
+// row * cols + col, with visited_value; to_visit is a stack of such indices,
+// empty again once done
+template <typename Matrix, typename T>
+void visit_in_place(Matrix & input, T const & visited_value, std::size_t start, std::vector<std::size_t> & to_visit)
 {
-  std::queue<Index> to_visit;
-  to_visit.emplace(row, col);
+  auto const cols = input.cols();
+  T const value = input(start / cols, start % cols);
+  input(start / cols, start % cols) = visited_value;
+  to_visit.push_back(start);
   while (!to_visit.empty())
   {
-    auto [row, col] = to_visit.front();
-    visited(row, col) = true;
-    add_neighbours_to_queue(input, to_visit, visited, row, col);
-    to_visit.pop();
+    auto const cell = to_visit.back();
+    to_visit.pop_back();
+    auto const row = cell / cols;
+    auto const col = cell % cols;
+    auto const add_if_matches = [&](std::size_t nrow, std::size_t ncol) {
+      if (input(nrow, ncol) == value)
+      {
+        input(nrow, ncol) = visited_value;
+        to_visit.push_back(nrow * cols + ncol);
+      }
+    };
+    if (row > 0) add_if_matches(row - 1, col);
+    if (col > 0) add_if_matches(row, col - 1);
+    if (row < input.rows() - 1) add_if_matches(row + 1, col);
+    if (col < cols - 1) add_if_matches(row, col + 1);
   }
 }
 
 } // namespace Details
 
-template <typename Matrix>
-int get_number_of_islands(Matrix const & input)
+/*
+ * Counts islands by a depth first flood fill from each cell not visited yet.
+ * Cells are connected as given by the Connectivity policy, FourConnected or
+ * EightConnected, when equivalent(neighbour, cell) holds, which must be
+ * symmetric. Each combination compiles to its own neighbour loop, unrolled
+ * and free of bounds checks thanks to a border of visited flags.
+ */
+template <typename Connectivity = FourConnected, typename Equivalent = std::equal_to<>>
+struct BasicFloodFill
 {
-  int result = 0;
-  DynamicMatrix<bool> visited{std::vector<bool>(input.rows() * input.cols(), false),
-                              input.rows(), input.cols()};
-  for (auto r = 0u; r < input.rows(); ++r)
+  Equivalent equivalent{};
+
+  template <typename Matrix>
+  int operator()(Matrix const & input) const
+  {
+    IslandsWorkspace workspace;
+    return (*this)(input, workspace);
+  }
+
+  template <typename Matrix>
+  int operator()(Matrix const & input, IslandsWorkspace & workspace) const
   {
-    for (auto c = 0u; c < input.cols(); ++c)
+    auto & visited = workspace.visited;
+    Details::reset_padded(visited, input.rows(), input.cols());
+    if (visited.size() - 1 <= std::numeric_limits<std::uint32_t>::max())
+      return Details::island_count(Details::flood_fill<Connectivity>(input, equivalent, visited, workspace.frontier));
+    return Details::island_count(Details::flood_fill<Connectivity>(input, equivalent, visited, workspace.wide_frontier));
+  }
+};
+
+using FloodFill = BasicFloodFill<>;
+
+/*
+ * Number of islands, that is areas of equal cells connected horizontally or
+ * vertically unless the engine connects them otherwise, in input. Counted by
+ * given engine, which is a policy object callable with the matrix. Engines
+ * throw std::overflow_error if there are more islands than an int can count.
+ */
+template <typename Engine = FloodFill, typename Matrix>
+int get_number_of_islands(Matrix const & input, Engine const & engine = Engine{})
+{
+  return engine(input);
+}
+
+/*
+ * Same as get_number_of_islands, but keeps buffers in workspace, which can be
+ * reused by later calls to count islands of many matrices allocating only
+ * while they grow. Engine must be callable with the matrix and workspace.
+ */
+template <typename Engine = FloodFill, typename Matrix>
+int get_number_of_islands(Matrix const & input, IslandsWorkspace & workspace, Engine const & engine = Engine{})
+{
+  return engine(input, workspace);
+}
+
+/*
+ * Same as get_number_of_islands, but marks visited cells in input itself, by
+ * overwriting them with visited_value, which must not occur in input. Needs
+ * no memory for visited flags, only a stack of cells to visit shared by all
+ * islands, but leaves input filled with visited_value.
+ */
+template <typename Matrix, typename T>
+int get_number_of_islands_in_place(Matrix & input, T const & visited_value)
+{
+  std::size_t result = 0;
+  std::vector<std::size_t> to_visit;
+  for (std::size_t r = 0; r < input.rows(); ++r)
+  {
+    for (std::size_t c = 0; c < input.cols(); ++c)
     {
-      if (!visited(r, c))
+      if (!(input(r, c) == visited_value))
       {
         ++result;
-        Details::visit(input, visited, r, c);
+        Details::visit_in_place(input, visited_value, r * input.cols() + c, to_visit);
       }
     }
   }
 
-  return result;
+  return Details::island_count(result);
 }
 
 } // namespace islands
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "dynamic_matrix.hpp"
+#include "scanline_islands.hpp"
+#include "union_find.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace islands
+{
+
+/*
+ * Statistics of islands kept as separate arrays indexed by island label:
+ * number of cells, inclusive bounding box and the value of the cells.
+ */
+template <typename T>
+struct IslandStatistics
+{
+  std::vector<std::size_t> area;
+  std::vector<std::size_t> top;
+  std::vector<std::size_t> bottom;
+  std::vector<std::size_t> left;
+  std::vector<std::size_t> right;
+  std::vector<T> value;
+
+  std::size_t size() const
+  {
+    return area.size();
+  }
+
+  void reserve(std::size_t islands)
+  {
+    area.reserve(islands);
+    top.reserve(islands);
+    bottom.reserve(islands);
+    left.reserve(islands);
+    right.reserve(islands);
+    value.reserve(islands);
+  }
+
+  // appends an island of a single run of cells
+  void push_back(std::size_t row, std::size_t first_col, std::size_t last_col, T const & cell)
+  {
+    area.push_back(last_col - first_col + 1);
+    top.push_back(row);
+    bottom.push_back(row);
+    left.push_back(first_col);
+    right.push_back(last_col);
+    value.push_back(cell);
+  }
+
+  // extends island to cover a run of cells, in a row not above those added
+  // before
+  void add(std::size_t island, std::size_t row, std::size_t first_col, std::size_t last_col)
+  {
+    area[island] += last_col - first_col + 1;
+    bottom[island] = row;
+    left[island] = std::min(left[island], first_col);
+    right[island] = std::max(right[island], last_col);
+  }
+};
+
+template <typename T>
+struct LabeledIslands
+{
+  DynamicMatrix<std::uint32_t> labels;
+  IslandStatistics<T> islands;
+};
+
+/*
+ * Labels islands with numbers from 0, in the order of their first cells row
+ * by row, and gathers their statistics, reading input once, row by row.
+ * Runs of equal cells are labeled and united as in Scanline, then the label
+ * image is relabeled with islands, which are known by then, collecting
+ * statistics run by run. Only the union-find and the value of each run are
+ * kept besides the result.
+ * Counting islands with get_number_of_islands is cheaper if that's all
+ * that's needed.
+ */
+template <typename Matrix>
+auto label_islands(Matrix const & input)
+{
+  using T = std::decay_t<decltype(input(0, 0))>;
+  auto const rows = input.rows();
+  auto const cols = input.cols();
+  LabeledIslands<T> result{{std::vector<std::uint32_t>(rows * cols), rows, cols}, {}};
+  auto & image = result.labels.storage;
+  auto & islands = result.islands;
+  if (rows == 0 || cols == 0)
+    return result;
+
+  UnionFind labels;
+  std::vector<T> run_values;
+  std::vector<Details::Run<T>> above;
+  std::vector<Details::Run<T>> runs;
+  std::size_t merged = 0;
+  for (std::size_t row = 0; row < rows; ++row)
+  {
+    Details::extract_runs(cols, [&](std::size_t col) { return input(row, col); }, runs, labels);
+    if (row > 0)
+      merged += Details::connect_runs(above, runs, labels);
+    for (auto const & run : runs)
+    {
+      run_values.push_back(run.value);
+      std::fill(image.begin() + static_cast<std::ptrdiff_t>(row * cols + run.begin),
+                image.begin() + static_cast<std::ptrdiff_t>(row * cols + run.end), run.label);
+    }
+    std::swap(above, runs);
+  }
+
+  // runs are told apart by their labels, each is relabeled with its island
+  constexpr auto unnumbered = std::numeric_limits<std::uint32_t>::max();
+  std::vector<std::uint32_t> island_of_root(labels.size(), unnumbered);
+  islands.reserve(labels.size() - merged);
+  for (std::size_t row = 0; row < rows; ++row)
+  {
+    auto const cells = image.begin() + static_cast<std::ptrdiff_t>(row * cols);
+    for (std::size_t begin = 0, end; begin < cols; begin = end)
+    {
+      auto const run = cells[static_cast<std::ptrdiff_t>(begin)];
+      for (end = begin + 1; end < cols && cells[static_cast<std::ptrdiff_t>(end)] == run; ++end)
+      {
+      }
+      auto const root = labels.find(run);
+      auto & island = island_of_root[root];
+      if (island == unnumbered)
+      {
+        island = static_cast<std::uint32_t>(islands.size());
+        islands.push_back(row, begin, end - 1, run_values[root]);
+      }
+      else
+        islands.add(island, row, begin, end - 1);
+      std::fill(cells + static_cast<std::ptrdiff_t>(begin), cells + static_cast<std::ptrdiff_t>(end), island);
+    }
+  }
+  return result;
+}
+
+} // namespace islands
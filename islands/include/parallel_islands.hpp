@@ -0,0 +1,214 @@
+#pragma once
+
+#include "islands.hpp"
+#include "union_find.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace islands
+{
+
+namespace Details
+{
+
+constexpr std::uint32_t unlabeled = std::numeric_limits<std::uint32_t>::max();
+
+/*
+ * Calls a worker made by make_worker on each of up to threads threads (0
+ * meaning one per core), the workers take task indices from a shared counter
+ * until all tasks are done. Threads are started for each call and joined
+ * before it returns. The first exception thrown by a worker stops the others
+ * from taking further tasks and is rethrown once all threads are joined.
+ */
+template <typename MakeWorker>
+void run_tasks(unsigned threads, std::size_t tasks, MakeWorker const & make_worker)
+{
+  std::atomic<std::size_t> next_task{0};
+  std::exception_ptr failure;
+  std::mutex failure_mutex;
+  auto const work = [&] {
+    try
+    {
+      auto worker = make_worker();
+      for (std::size_t task; (task = next_task.fetch_add(1, std::memory_order_relaxed)) < tasks;)
+        worker(task);
+    }
+    catch (...)
+    {
+      next_task.store(tasks, std::memory_order_relaxed);
+      std::lock_guard<std::mutex> const lock{failure_mutex};
+      if (!failure)
+        failure = std::current_exception();
+    }
+  };
+
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  auto const workers = std::min<std::size_t>(threads, tasks);
+  std::vector<std::thread> helpers;
+  try
+  {
+    for (std::size_t i = 1; i < workers; ++i)
+      helpers.emplace_back(work);
+  }
+  catch (...)
+  { // fewer threads than asked for, the ones running take the remaining tasks
+  }
+  work();
+  for (auto & helper : helpers)
+    helper.join();
+  if (failure)
+    std::rethrow_exception(failure);
+}
+
+/*
+ * Islands of a band of rows, labeled as if there were nothing around it.
+ * Labels of the cells of its first and last row are renumbered from 0 to
+ * border_labels - 1, only those can be merged with the neighbouring bands.
+ */
+struct Band
+{
+  std::size_t islands = 0;
+  std::vector<std::uint32_t> top;
+  std::vector<std::uint32_t> bottom;
+  std::uint32_t border_labels = 0;
+};
+
+// scratch buffers of a thread labeling bands
+struct BandLabeling
+{
+  std::vector<std::uint32_t> labels;
+  std::vector<std::size_t> to_visit;
+  std::vector<std::uint32_t> border_label;
+};
+
+template <typename Matrix>
+void flood_band(Matrix const & input, std::size_t first_row, std::size_t rows, BandLabeling & scratch,
+                std::size_t start, std::uint32_t label)
+{
+  auto const cols = input.cols();
+  auto & labels = scratch.labels;
+  auto & to_visit = scratch.to_visit;
+  auto const value = input(first_row + start / cols, start % cols);
+  auto const add_if_matches = [&](std::size_t cell) {
+    if (labels[cell] == unlabeled && input(first_row + cell / cols, cell % cols) == value)
+    {
+      labels[cell] = label;
+      to_visit.push_back(cell);
+    }
+  };
+  labels[start] = label;
+  to_visit.push_back(start);
+  while (!to_visit.empty())
+  {
+    auto const cell = to_visit.back();
+    to_visit.pop_back();
+    auto const row = cell / cols;
+    auto const col = cell % cols;
+    if (row > 0) add_if_matches(cell - cols);
+    if (col > 0) add_if_matches(cell - 1);
+    if (row < rows - 1) add_if_matches(cell + cols);
+    if (col < cols - 1) add_if_matches(cell + 1);
+  }
+}
+
+template <typename Matrix>
+void label_band(Matrix const & input, std::size_t first_row, std::size_t rows, BandLabeling & scratch, Band & band)
+{
+  auto const cols = input.cols();
+  auto const cells = rows * cols;
+  scratch.labels.assign(cells, unlabeled);
+  std::uint32_t label = 0;
+  for (std::size_t cell = 0; cell < cells; ++cell)
+    if (scratch.labels[cell] == unlabeled)
+      flood_band(input, first_row, rows, scratch, cell, label++);
+  band.islands = label;
+
+  scratch.border_label.assign(label, unlabeled);
+  auto const renumber = [&](std::size_t begin, std::vector<std::uint32_t> & border) {
+    border.resize(cols);
+    for (std::size_t col = 0; col < cols; ++col)
+    {
+      auto & renumbered = scratch.border_label[scratch.labels[begin + col]];
+      if (renumbered == unlabeled)
+        renumbered = band.border_labels++;
+      border[col] = renumbered;
+    }
+  };
+  renumber(0, band.top);
+  renumber(cells - cols, band.bottom);
+}
+
+} // namespace Details
+
+/*
+ * Counts islands of bands of tile_rows rows on up to threads threads (0
+ * meaning one per core), then merges the islands touching the borders of
+ * adjacent bands, also in parallel, with a lock-free union-find over them.
+ * Bands span whole rows, so each is read row by row and meets other bands
+ * on one row only.
+ */
+struct Parallel
+{
+  unsigned threads = 0;
+  std::size_t tile_rows = 64;
+
+  template <typename Matrix>
+  int operator()(Matrix const & input) const
+  {
+    auto const rows = input.rows();
+    auto const cols = input.cols();
+    if (rows == 0 || cols == 0)
+      return 0;
+    auto const band_rows = std::max<std::size_t>(tile_rows, 1);
+    auto const band_count = (rows + band_rows - 1) / band_rows;
+    std::vector<Details::Band> bands(band_count);
+    Details::run_tasks(threads, band_count, [&] {
+      return [&, scratch = Details::BandLabeling{}](std::size_t band) mutable {
+        auto const first_row = band * band_rows;
+        Details::label_band(input, first_row, std::min(band_rows, rows - first_row), scratch, bands[band]);
+      };
+    });
+
+    std::size_t result = 0;
+    std::vector<std::uint32_t> offsets;
+    offsets.reserve(band_count);
+    std::size_t border_labels = 0;
+    for (auto const & band : bands)
+    {
+      result += band.islands;
+      offsets.push_back(static_cast<std::uint32_t>(border_labels));
+      border_labels += band.border_labels;
+    }
+
+    ConcurrentUnionFind border_islands{border_labels};
+    std::atomic<std::size_t> merged{0};
+    Details::run_tasks(threads, band_count - 1, [&] {
+      return [&](std::size_t border) {
+        auto const & upper = bands[border];
+        auto const & lower = bands[border + 1];
+        auto const row = (border + 1) * band_rows;
+        std::size_t merged_here = 0;
+        for (std::size_t col = 0; col < cols; ++col)
+        {
+          // runs of cells of the same pair of islands need to be merged once
+          if (col > 0 && upper.bottom[col] == upper.bottom[col - 1] && lower.top[col] == lower.top[col - 1])
+            continue;
+          if (input(row - 1, col) == input(row, col)
+              && border_islands.unite(offsets[border] + upper.bottom[col], offsets[border + 1] + lower.top[col]))
+            ++merged_here;
+        }
+        merged.fetch_add(merged_here, std::memory_order_relaxed);
+      };
+    });
+    return Details::island_count(result - merged.load());
+  }
+};
+
+} // namespace islands
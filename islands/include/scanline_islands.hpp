@@ -0,0 +1,104 @@
+#pragma once
+
+#include "islands.hpp"
+#include "union_find.hpp"
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace islands
+{
+
+namespace Details
+{
+
+// maximal horizontal stretch of equal cells
+template <typename T>
+struct Run
+{
+  std::size_t begin;
+  std::size_t end;
+  T value;
+  std::uint32_t label;
+};
+
+// runs of a row of cols cells given by cell(col), labeled with new
+// union-find elements
+template <typename T, typename Cell>
+void extract_runs(std::size_t cols, Cell const & cell, std::vector<Run<T>> & runs, UnionFind & labels)
+{
+  runs.clear();
+  std::size_t begin = 0;
+  T value = cell(0);
+  for (std::size_t col = 1; col < cols; ++col)
+  {
+    T const next = cell(col);
+    if (next == value)
+      continue;
+    runs.push_back({begin, col, value, labels.add()});
+    begin = col;
+    value = next;
+  }
+  runs.push_back({begin, cols, value, labels.add()});
+}
+
+// unites runs of adjacent rows equal in value and overlapping on some column,
+// or touching at a corner if Connectivity is diagonal; returns the number of
+// islands merged
+template <typename Connectivity = FourConnected, typename T>
+std::size_t connect_runs(std::vector<Run<T>> const & above, std::vector<Run<T>> const & runs, UnionFind & labels)
+{
+  constexpr std::size_t reach = Connectivity::diagonal ? 1 : 0;
+  std::size_t merged = 0;
+  auto first_overlapping = above.cbegin();
+  for (auto const & run : runs)
+  {
+    // runs of both rows cover all columns in order, the last run overlapping
+    // this one may overlap the next one too
+    while (first_overlapping->end + reach <= run.begin)
+      ++first_overlapping;
+    for (auto it = first_overlapping; it != above.cend() && it->begin < run.end + reach; ++it)
+      if (it->value == run.value && labels.unite(it->label, run.label))
+        ++merged;
+  }
+  return merged;
+}
+
+} // namespace Details
+
+/*
+ * Counts islands over runs of equal cells, reading the input strictly row by
+ * row. Runs get labels which are united with those of touching, equal runs of
+ * the row above, as in the first pass of two-pass labeling. Counting needs no
+ * second pass resolving labels: islands are the runs less the unions made.
+ * Keeps runs of two rows and a union-find element per run. Cells are connected
+ * as given by the Connectivity policy; runs are maximal stretches of equal
+ * cells, so unlike BasicFloodFill there is no choice of predicate.
+ */
+template <typename Connectivity = FourConnected>
+struct BasicScanline
+{
+  template <typename Matrix>
+  int operator()(Matrix const & input) const
+  {
+    if (input.rows() == 0 || input.cols() == 0)
+      return 0;
+    using T = std::decay_t<decltype(input(0, 0))>;
+    UnionFind labels;
+    std::vector<Details::Run<T>> above;
+    std::vector<Details::Run<T>> runs;
+    std::size_t merged = 0;
+    for (std::size_t row = 0; row < input.rows(); ++row)
+    {
+      Details::extract_runs(input.cols(), [&](std::size_t col) { return input(row, col); }, runs, labels);
+      if (row > 0)
+        merged += Details::connect_runs<Connectivity>(above, runs, labels);
+      std::swap(above, runs);
+    }
+    return Details::island_count(labels.size() - merged);
+  }
+};
+
+using Scanline = BasicScanline<>;
+
+} // namespace islands
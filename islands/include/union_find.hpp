@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace islands
+{
+
+/*
+ * Disjoint sets of elements added one at a time, numbered from 0. A root is
+ * linked below the older one, paths are halved on the way up.
+ */
+class UnionFind
+{
+public:
+  std::uint32_t add()
+  {
+    auto const element = static_cast<std::uint32_t>(parent.size());
+    parent.push_back(element);
+    return element;
+  }
+
+  std::uint32_t find(std::uint32_t element)
+  {
+    while (parent[element] != element)
+    {
+      parent[element] = parent[parent[element]];
+      element = parent[element];
+    }
+    return element;
+  }
+
+  // returns whether the elements were in different sets
+  bool unite(std::uint32_t first, std::uint32_t second)
+  {
+    first = find(first);
+    second = find(second);
+    if (first == second)
+      return false;
+    if (first < second)
+      std::swap(first, second);
+    parent[first] = second;
+    return true;
+  }
+
+  std::size_t size() const
+  {
+    return parent.size();
+  }
+
+  void clear()
+  {
+    parent.clear();
+  }
+
+private:
+  std::vector<std::uint32_t> parent;
+};
+
+/*
+ * Disjoint sets of 0..size-1 safe to unite and find from many threads at
+ * once, without locks. A root is linked below the smaller one by a
+ * compare-and-swap, which fails if it stopped being a root meanwhile, so no
+ * cycles can form. Paths are halved on the way up.
+ */
+class ConcurrentUnionFind
+{
+public:
+  explicit ConcurrentUnionFind(std::size_t size)
+  : parent(size)
+  {
+    for (std::size_t i = 0; i < size; ++i)
+      parent[i].store(static_cast<std::uint32_t>(i), std::memory_order_relaxed);
+  }
+
+  std::uint32_t find(std::uint32_t element)
+  {
+    while (true)
+    {
+      auto up = parent[element].load(std::memory_order_acquire);
+      if (up == element)
+        return element;
+      auto const grandparent = parent[up].load(std::memory_order_acquire);
+      if (grandparent != up)
+        parent[element].compare_exchange_weak(up, grandparent, std::memory_order_acq_rel);
+      element = grandparent;
+    }
+  }
+
+  // returns whether the elements were in different sets
+  bool unite(std::uint32_t first, std::uint32_t second)
+  {
+    while (true)
+    {
+      first = find(first);
+      second = find(second);
+      if (first == second)
+        return false;
+      if (first < second)
+        std::swap(first, second);
+      auto expected = first;
+      if (parent[first].compare_exchange_strong(expected, second, std::memory_order_acq_rel))
+        return true;
+    }
+  }
+
+private:
+  std::vector<std::atomic<std::uint32_t>> parent;
+};
+
+} // namespace islands
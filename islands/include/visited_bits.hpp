@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace islands
+{
+
+/*
+ * Visited flags of cells, one bit each, packed in 64 bit words and accessed
+ * by linear cell index. Cells left to visit are found a word at a time,
+ * skipping 64 visited ones in a single step.
+ */
+class VisitedBits
+{
+public:
+  explicit VisitedBits(std::size_t size = 0)
+  : words((size + 63) / 64, 0)
+  , size_{size}
+  {}
+
+  // marks all cells as not visited, reusing allocated words
+  void reset(std::size_t size)
+  {
+    words.assign((size + 63) / 64, 0);
+    size_ = size;
+  }
+
+  bool test(std::size_t cell) const
+  {
+    return (words[cell / 64] >> (cell % 64)) & 1u;
+  }
+
+  void set(std::size_t cell)
+  {
+    words[cell / 64] |= std::uint64_t{1} << (cell % 64);
+  }
+
+  // first cell not visited from given one on, or size() if there is none
+  std::size_t next_unvisited(std::size_t cell) const
+  {
+    if (cell >= size_)
+      return size_;
+    auto word = cell / 64;
+    auto unvisited = ~words[word] & (~std::uint64_t{0} << (cell % 64));
+    while (unvisited == 0)
+    {
+      if (++word == words.size())
+        return size_;
+      unvisited = ~words[word];
+    }
+    return std::min(size_, word * 64 + static_cast<std::size_t>(__builtin_ctzll(unvisited)));
+  }
+
+  std::size_t size() const
+  {
+    return size_;
+  }
+
+private:
+  std::vector<std::uint64_t> words;
+  std::size_t size_;
+};
+
+} // namespace islands
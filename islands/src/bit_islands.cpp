@@ -0,0 +1 @@
+#include "bit_islands.hpp"
@@ -0,0 +1 @@
+#include "connectivity.hpp"
@@ -0,0 +1 @@
+#include "island_counter.hpp"
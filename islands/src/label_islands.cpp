@@ -0,0 +1 @@
+#include "label_islands.hpp"
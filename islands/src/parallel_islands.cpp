@@ -0,0 +1 @@
+#include "parallel_islands.hpp"
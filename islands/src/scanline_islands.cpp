@@ -0,0 +1 @@
+#include "scanline_islands.hpp"
@@ -0,0 +1 @@
+#include "union_find.hpp"
@@ -0,0 +1 @@
+#include "visited_bits.hpp"
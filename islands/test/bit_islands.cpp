@@ -0,0 +1,47 @@
+#include "bit_islands.hpp"
+#include "bit_matrix.hpp"
+#include "dynamic_matrix.hpp"
+#include "islands.hpp"
+#include <catch2/catch.hpp>
+#include <vector>
+
+namespace
+{
+using namespace islands;
+
+TEST_CASE("runs of words are united across rows", "[BitScanline]")
+{
+  DynamicMatrix<int> diag{{
+    1, 0,
+    0, 1}, 2, 2};
+  REQUIRE(4 == get_number_of_islands<BitScanline>(BitMatrix{diag}));
+
+  // runs of equal cells in both rows split by runs starting in one of them
+  DynamicMatrix<char> comb {{
+    1, 1, 1, 1, 1, 1, 1,
+    1, 0, 1, 0, 1, 0, 1,
+    0, 0, 0, 0, 0, 0, 0,
+    0, 1, 1, 0, 1, 1, 0}, 4, 7};
+  REQUIRE(4 == get_number_of_islands<BitScanline>(BitMatrix{comb}));
+
+  // rows equal to the one above, before and after runs merge
+  DynamicMatrix<char> pillars {{
+    1, 0, 1, 0,
+    1, 0, 1, 0,
+    1, 1, 1, 0,
+    1, 1, 1, 0,
+    0, 0, 1, 0}, 5, 4};
+  REQUIRE(4 == get_number_of_islands<BitScanline>(BitMatrix{pillars}));
+
+
+  // uniform stretches spanning words
+  auto const rows = GENERATE(1u, 2u, 33u);
+  auto const cols = GENERATE(63u, 64u, 65u, 200u);
+  DynamicMatrix<int> blocks{std::vector<int>(rows * cols), rows, cols};
+  for (std::size_t cell = 0; cell < blocks.storage.size(); ++cell)
+    blocks.storage[cell] = static_cast<int>((cell / cols / 5 + cell % cols / 70) % 2);
+  CAPTURE(rows, cols);
+  REQUIRE(get_number_of_islands(blocks) == get_number_of_islands<BitScanline>(BitMatrix{blocks}));
+}
+
+} // namespace
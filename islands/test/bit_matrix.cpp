@@ -0,0 +1,30 @@
+#include "bit_matrix.hpp"
+#include "dynamic_matrix.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+using namespace islands;
+
+TEST_CASE("bit matrix cells are packed across words", "[BitMatrix]")
+{
+  DynamicMatrix<int> input{std::vector<int>(3 * 130), 3, 130};
+  input(0, 0) = 1;
+  input(1, 63) = 5;
+  input(1, 64) = 1;
+  input(2, 129) = -1;
+  BitMatrix bits{input};
+  REQUIRE(bits.words_per_row() == 3);
+  REQUIRE(bits.row(0)[0] == 1);
+  REQUIRE(bits.row(1)[0] == std::uint64_t{1} << 63);
+  REQUIRE(bits.row(1)[1] == 1);
+  REQUIRE(bits.row(2)[2] == 2);
+  REQUIRE(bits(2, 129));
+  bits.set(2, 129, false);
+  REQUIRE_FALSE(bits(2, 129));
+  REQUIRE(bits.row(2)[2] == 0);
+}
+
+} // namespace
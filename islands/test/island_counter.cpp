@@ -0,0 +1,48 @@
+#include "dynamic_matrix.hpp"
+#include "island_counter.hpp"
+#include "islands.hpp"
+#include "random_matrix.hpp"
+#include <catch2/catch.hpp>
+#include <vector>
+
+namespace
+{
+using namespace islands;
+using test::random_matrix;
+
+TEST_CASE("islands counted row by row", "[IslandCounter]")
+{
+  auto const cols = GENERATE(1u, 2u, 9u, 64u);
+  auto const values = GENERATE(2, 3);
+  auto const input = random_matrix(50, cols, values, cols * 7u + 3);
+  IslandCounter<int> counter{cols};
+  REQUIRE(counter.count() == 0);
+  for (std::size_t row = 0; row < input.rows(); ++row)
+  {
+    counter.push_row(&input.storage[row * cols]);
+    // islands of the rows pushed so far
+    DynamicMatrix<int> const top{{input.storage.begin(), input.storage.begin() + (row + 1) * cols}, row + 1, cols};
+    CAPTURE(cols, values, row);
+    REQUIRE(get_number_of_islands(top) == counter.count());
+  }
+  counter.reset();
+  REQUIRE(counter.count() == 0);
+}
+
+TEST_CASE("islands merged by later rows counted once", "[IslandCounter]")
+{
+  // ones form a U, seen as two islands until the last row
+  std::vector<std::vector<char>> const rows{
+    {1, 0, 0, 1},
+    {1, 0, 0, 1},
+    {1, 1, 1, 1}};
+  IslandCounter<char> counter{4};
+  counter.push_row(rows[0].data());
+  REQUIRE(counter.count() == 3);
+  counter.push_row(rows[1].data());
+  REQUIRE(counter.count() == 3);
+  counter.push_row(rows[2].data());
+  REQUIRE(counter.count() == 2);
+}
+
+} // namespace
@@ -0,0 +1,99 @@
+#include "connectivity.hpp"
+#include "dynamic_matrix.hpp"
+#include "island_index.hpp"
+#include "islands.hpp"
+#include "random_matrix.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+using namespace islands;
+using test::random_matrix;
+
+TEST_CASE("islands split and merged by updates", "[IslandIndex]")
+{
+  DynamicMatrix<int> cross{{
+    0, 1, 0,
+    1, 1, 1,
+    0, 1, 0}, 3, 3};
+  IslandIndex<int> index{cross};
+  REQUIRE(5 == index.count());
+  // the center leaving splits the cross into four arms
+  index.set(1, 1, 0);
+  REQUIRE(9 == index.count());
+  REQUIRE_FALSE(index.connected(0, 1, 1, 0));
+  REQUIRE_FALSE(index.connected(0, 0, 1, 1));
+  index.set(1, 1, 1);
+  REQUIRE(5 == index.count());
+  REQUIRE(index.connected(0, 1, 2, 1));
+  // a cell on its own leaves no island behind
+  index.set(0, 0, 1);
+  REQUIRE(4 == index.count());
+  index.set(0, 0, 2);
+  REQUIRE(5 == index.count());
+  index.set(std::vector<IslandIndex<int>::Update>{{1, 0, 0}, {1, 2, 0}});
+  REQUIRE(4 == index.count());
+
+  // arms touch at corners, as do corners and the center
+  IslandIndex<int, EightConnected> diagonal{cross};
+  REQUIRE(5 == diagonal.count());
+  diagonal.set(1, 1, 0);
+  REQUIRE(2 == diagonal.count());
+  REQUIRE(diagonal.connected(0, 0, 2, 2));
+}
+
+TEST_CASE("islands counted under updates agree with counting anew", "[IslandIndex]")
+{
+  auto const rows = GENERATE(1u, 2u, 17u);
+  auto const cols = GENERATE(1u, 3u, 40u);
+  auto const values = GENERATE(2, 3);
+  auto const input = random_matrix(rows, cols, values, rows * 100u + cols);
+  IslandIndex<int> index{input};
+  IslandIndex<int, EightConnected> diagonal{input};
+  CAPTURE(rows, cols, values);
+  REQUIRE(get_number_of_islands(input) == static_cast<int>(index.count()));
+  REQUIRE(get_number_of_islands<BasicFloodFill<EightConnected>>(input) == static_cast<int>(diagonal.count()));
+  IslandIndex<int> batched{input};
+  std::uint32_t seed = 17;
+  for (int batch = 0; batch < 30; ++batch)
+  {
+    std::vector<IslandIndex<int>::Update> updates;
+    for (int update = 0; update < 20; ++update)
+    {
+      seed = seed * 1103515245u + 12345u;
+      auto const cell = (seed >> 8) % (rows * cols);
+      auto const value = static_cast<int>((seed >> 24) % static_cast<std::uint32_t>(values));
+      index.set(cell / cols, cell % cols, value);
+      diagonal.set(cell / cols, cell % cols, value);
+      updates.push_back({cell / cols, cell % cols, value});
+    }
+    batched.set(updates);
+    CAPTURE(batch);
+    REQUIRE(get_number_of_islands(index.matrix()) == static_cast<int>(index.count()));
+    REQUIRE(index.count() == batched.count());
+    REQUIRE(get_number_of_islands<BasicFloodFill<EightConnected>>(diagonal.matrix())
+            == static_cast<int>(diagonal.count()));
+    // neighbours on the same island iff equal
+    for (std::size_t row = 0; row + 1 < rows; ++row)
+      for (std::size_t col = 0; col < cols; ++col)
+        REQUIRE((index(row, col) == index(row + 1, col)) == index.connected(row, col, row + 1, col));
+  }
+}
+
+TEST_CASE("batches splitting large islands label anew", "[IslandIndex]")
+{
+  // a row cut in halves, then quarters and so on, each cut searches through
+  // the smaller half
+  IslandIndex<int> index{DynamicMatrix<int>{std::vector<int>(256, 0), 1, 256}};
+  std::vector<IslandIndex<int>::Update> cuts;
+  for (std::size_t step = 128; step > 1; step /= 2)
+    for (std::size_t col = step; col < 256; col += 2 * step)
+      cuts.push_back({0, col, 1});
+  index.set(cuts);
+  REQUIRE(get_number_of_islands(index.matrix()) == static_cast<int>(index.count()));
+  REQUIRE(255 == index.count());
+}
+
+} // namespace
@@ -1,9 +1,97 @@
+#include "bit_islands.hpp"
+#include "bit_matrix.hpp"
+#include "island_counter.hpp"
+#include "island_index.hpp"
 #include "islands.hpp"
+#include "label_islands.hpp"
+#include "mmap_matrix.hpp"
+#include "parallel_islands.hpp"
+#include "random_matrix.hpp"
+#include "scanline_islands.hpp"
+#include "visited_bits.hpp"
+#include <algorithm>
 #include <catch2/catch.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace
 {
 using namespace islands;
+using test::random_matrix;
+
+// removes the file when going out of scope
+struct TemporaryFile
+{
+  explicit TemporaryFile(char const * name)
+  : path{(std::filesystem::temp_directory_path() / name).string()}
+  {}
+  ~TemporaryFile()
+  {
+    std::remove(path.c_str());
+  }
+
+  std::string path;
+};
+
+/*
+ * An engine counting islands of a matrix, connecting cells at corners too if
+ * diagonal, usable on matrices of 0 and 1 only if binary.
+ */
+struct Engine
+{
+  char const * name;
+  bool diagonal;
+  bool binary;
+  std::function<int(DynamicMatrix<int> const &)> count;
+};
+
+std::vector<Engine> const engines{
+  {"flood fill in place", false, false,
+   [](DynamicMatrix<int> const & input) {
+     auto copy = input;
+     return get_number_of_islands_in_place(copy, -1);
+   }},
+  {"flood fill with workspace", false, false,
+   [](DynamicMatrix<int> const & input) {
+     IslandsWorkspace workspace;
+     return get_number_of_islands(input, workspace);
+   }},
+  {"flood fill of bits", false, true,
+   [](DynamicMatrix<int> const & input) { return get_number_of_islands(BitMatrix{input}); }},
+  {"scanline", false, false, [](DynamicMatrix<int> const & input) { return get_number_of_islands<Scanline>(input); }},
+  {"bit scanline", false, true,
+   [](DynamicMatrix<int> const & input) { return get_number_of_islands<BitScanline>(BitMatrix{input}); }},
+  {"parallel, bands of a row", false, false,
+   [](DynamicMatrix<int> const & input) { return get_number_of_islands(input, Parallel{1, 1}); }},
+  {"parallel, bands of 5 rows", false, false,
+   [](DynamicMatrix<int> const & input) { return get_number_of_islands(input, Parallel{3, 5}); }},
+  {"parallel, bands of 64 rows", false, false,
+   [](DynamicMatrix<int> const & input) { return get_number_of_islands(input, Parallel{3, 64}); }},
+  {"parallel, a single band", false, false,
+   [](DynamicMatrix<int> const & input) { return get_number_of_islands(input, Parallel{2, 1000}); }},
+  {"island counter", false, false,
+   [](DynamicMatrix<int> const & input) {
+     IslandCounter<int> counter{input.cols()};
+     for (std::size_t row = 0; row < input.rows(); ++row)
+       counter.push_row(&input.storage[row * input.cols()]);
+     return counter.count();
+   }},
+  {"island index", false, false,
+   [](DynamicMatrix<int> const & input) { return static_cast<int>(IslandIndex<int>{input}.count()); }},
+  {"label islands", false, false,
+   [](DynamicMatrix<int> const & input) { return static_cast<int>(label_islands(input).islands.size()); }},
+  {"eight connected scanline", true, false,
+   [](DynamicMatrix<int> const & input) { return get_number_of_islands<BasicScanline<EightConnected>>(input); }},
+  {"eight connected island index", true, false,
+   [](DynamicMatrix<int> const & input) {
+     return static_cast<int>(IslandIndex<int, EightConnected>{input}.count());
+   }},
+};
 
 TEST_CASE("correctly calculated", "[islands counting]")
 {
@@ -26,5 +114,125 @@ TEST_CASE("correctly calculated", "[islands counting]")
   REQUIRE(6 == get_number_of_islands(multiple));
 }
 
+TEST_CASE("large uniform areas are flood filled", "[islands counting]")
+{
+  DynamicMatrix<int> uniform{std::vector<int>(600 * 600, 7), 600, 600};
+  REQUIRE(1 == get_number_of_islands(uniform));
+}
+
+TEST_CASE("cells touching at corners are connected by eight connectivity", "[islands counting]")
+{
+  DynamicMatrix<int> diag{{
+    1, 0,
+    0, 1}, 2, 2};
+  REQUIRE(2 == get_number_of_islands<BasicFloodFill<EightConnected>>(diag));
+
+  DynamicMatrix<int> checkerboard{std::vector<int>(9 * 9), 9, 9};
+  for (std::size_t cell = 0; cell < checkerboard.storage.size(); ++cell)
+    checkerboard.storage[cell] = static_cast<int>((cell / 9 + cell % 9) % 2);
+  REQUIRE(81 == get_number_of_islands(checkerboard));
+  REQUIRE(2 == get_number_of_islands<BasicFloodFill<EightConnected>>(checkerboard));
+}
+
+TEST_CASE("cells within tolerance are connected", "[islands counting]")
+{
+  // a ramp is a single island, though its ends differ by more than tolerance
+  DynamicMatrix<int> ramp{{
+    0, 1, 2, 3,
+    9, 9, 9, 4,
+    8, 7, 6, 5}, 3, 4};
+  REQUIRE(10 == get_number_of_islands(ramp));
+  REQUIRE(1 == get_number_of_islands(ramp, BasicFloodFill<FourConnected, WithinTolerance<int>>{{1}}));
+  REQUIRE(10 == get_number_of_islands(ramp, BasicFloodFill<FourConnected, WithinTolerance<int>>{{0}}));
+
+  DynamicMatrix<double> steps{{
+    0.0, 0.5, 3.0,
+    2.5, 1.0, 3.5}, 2, 3};
+  REQUIRE(3 == get_number_of_islands(steps, BasicFloodFill<FourConnected, WithinTolerance<double>>{{0.5}}));
+  REQUIRE(2 == get_number_of_islands(steps, BasicFloodFill<EightConnected, WithinTolerance<double>>{{1.5}}));
+  REQUIRE(1 == get_number_of_islands(steps, BasicFloodFill<EightConnected, WithinTolerance<double>>{{2.0}}));
+}
+
+TEST_CASE("workspace is reused between counts", "[islands counting]")
+{
+  IslandsWorkspace workspace;
+  auto const largest = random_matrix(40, 40, 2, 1);
+  REQUIRE(get_number_of_islands(largest) == get_number_of_islands(largest, workspace));
+  auto const frontier = workspace.frontier.data();
+  auto const capacity = workspace.frontier.capacity();
+  for (auto const size : {0u, 1u, 7u, 40u, 13u})
+  {
+    auto const input = random_matrix(size, 40 - size, 3, size);
+    CAPTURE(size);
+    REQUIRE(get_number_of_islands(input) == get_number_of_islands(input, workspace));
+    REQUIRE(get_number_of_islands<BasicFloodFill<EightConnected>>(input)
+            == get_number_of_islands<BasicFloodFill<EightConnected>>(input, workspace));
+    REQUIRE(workspace.frontier.data() == frontier);
+    REQUIRE(workspace.frontier.capacity() == capacity);
+  }
+}
+
+TEST_CASE("wide frontier of large matrices agrees with packed one", "[islands counting]")
+{
+  // matrices needing indices past 32 bits take too much memory for a test,
+  // the frontier used for them is checked on small ones instead
+  for (auto const size : {1u, 9u, 40u})
+  {
+    auto const input = random_matrix(size, 41 - size, 2, size);
+    VisitedBits visited;
+    std::vector<std::size_t> wide_frontier;
+    Details::reset_padded(visited, input.rows(), input.cols());
+    CAPTURE(size);
+    REQUIRE(static_cast<std::size_t>(get_number_of_islands(input))
+            == Details::flood_fill<FourConnected>(input, std::equal_to<>{}, visited, wide_frontier));
+    Details::reset_padded(visited, input.rows(), input.cols());
+    REQUIRE(static_cast<std::size_t>(get_number_of_islands<BasicFloodFill<EightConnected>>(input))
+            == Details::flood_fill<EightConnected>(input, std::equal_to<>{}, visited, wide_frontier));
+  }
+}
+
+TEST_CASE("counts beyond int are not narrowed", "[islands counting]")
+{
+  auto const largest = static_cast<std::size_t>(std::numeric_limits<int>::max());
+  REQUIRE(Details::island_count(largest) == std::numeric_limits<int>::max());
+  REQUIRE_THROWS_AS(Details::island_count(largest + 1), std::overflow_error);
+}
+
+TEST_CASE("counting in place fills input with the visited value", "[islands counting]")
+{
+  auto input = random_matrix(40, 65, 3, 4065);
+  auto const expected = get_number_of_islands(input);
+  REQUIRE(expected == get_number_of_islands_in_place(input, -1));
+  REQUIRE(std::all_of(input.storage.begin(), input.storage.end(), [](int cell) { return cell == -1; }));
+}
+
+TEST_CASE("every engine agrees with flood fill", "[islands counting]")
+{
+  auto const rows = GENERATE(0u, 1u, 2u, 7u, 33u, 129u);
+  auto const cols = GENERATE(1u, 2u, 3u, 64u, 65u, 100u, 200u);
+  auto const values = GENERATE(2, 3);
+  auto const input = random_matrix(rows, cols, values, rows * 1000u + cols);
+  auto const expected = get_number_of_islands(input);
+  auto const expected_diagonal = get_number_of_islands<BasicFloodFill<EightConnected>>(input);
+  for (auto const & engine : engines)
+  {
+    if (engine.binary && values != 2)
+      continue;
+    CAPTURE(rows, cols, values, engine.name);
+    REQUIRE((engine.diagonal ? expected_diagonal : expected) == engine.count(input));
+  }
+}
+
+TEST_CASE("islands counted in a mapped matrix", "[islands counting]")
+{
+  auto const input = random_matrix(70, 90, 3, 2024);
+  TemporaryFile const file{"islands_mmap_matrix.bin"};
+  MatrixFile::write(file.path.c_str(), input);
+  MmapMatrix<int> const mapped{file.path.c_str(), MmapMatrix<int>::Access::Sequential};
+  auto const expected = get_number_of_islands(input);
+  REQUIRE(expected == get_number_of_islands(mapped));
+  REQUIRE(expected == get_number_of_islands<Scanline>(mapped));
+  REQUIRE(expected == get_number_of_islands(mapped, Parallel{2, 16}));
 }
 
+} // namespace
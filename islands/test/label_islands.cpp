@@ -0,0 +1,78 @@
+#include "dynamic_matrix.hpp"
+#include "islands.hpp"
+#include "label_islands.hpp"
+#include "random_matrix.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+using namespace islands;
+using test::random_matrix;
+
+TEST_CASE("islands labeled with their statistics", "[label_islands]")
+{
+  DynamicMatrix<int> multiple {{
+    1, 1, 0, 1,
+    0, 1, 1, 1,
+    0, 0, 3, 3,
+    3, 3, 3, 3,
+    4, 3, 4, 3}, 5, 4};
+  auto const [labels, islands] = label_islands(multiple);
+  REQUIRE(labels.storage == std::vector<std::uint32_t>{
+    0, 0, 1, 0,
+    2, 0, 0, 0,
+    2, 2, 3, 3,
+    3, 3, 3, 3,
+    4, 3, 5, 3});
+  REQUIRE(islands.size() == 6);
+  REQUIRE(islands.area == std::vector<std::size_t>{6, 1, 3, 8, 1, 1});
+  REQUIRE(islands.value == std::vector<int>{1, 0, 0, 3, 4, 4});
+  REQUIRE(islands.top == std::vector<std::size_t>{0, 0, 1, 2, 4, 4});
+  REQUIRE(islands.bottom == std::vector<std::size_t>{1, 0, 2, 4, 4, 4});
+  REQUIRE(islands.left == std::vector<std::size_t>{0, 2, 0, 0, 0, 2});
+  REQUIRE(islands.right == std::vector<std::size_t>{3, 2, 1, 3, 0, 2});
+}
+
+TEST_CASE("labels and statistics agree with the input", "[label_islands]")
+{
+  auto const rows = GENERATE(0u, 1u, 6u, 31u);
+  auto const cols = GENERATE(1u, 5u, 40u);
+  auto const input = random_matrix(rows, cols, 3, rows * 31u + cols);
+  auto const [labels, islands] = label_islands(input);
+  CAPTURE(rows, cols);
+  REQUIRE(islands.size() == static_cast<std::size_t>(get_number_of_islands(input)));
+
+  IslandStatistics<int> expected;
+  std::uint32_t next_label = 0;
+  for (std::size_t row = 0; row < rows; ++row)
+  {
+    for (std::size_t col = 0; col < cols; ++col)
+    {
+      auto const label = labels(row, col);
+      // neighbours have the same label exactly when they're equal
+      if (row > 0)
+        REQUIRE((labels(row - 1, col) == label) == (input(row - 1, col) == input(row, col)));
+      if (col > 0)
+        REQUIRE((labels(row, col - 1) == label) == (input(row, col - 1) == input(row, col)));
+      // numbered in the order of first cells
+      REQUIRE(label <= next_label);
+      if (label == next_label)
+      {
+        ++next_label;
+        expected.push_back(row, col, col, input(row, col));
+      }
+      else
+        expected.add(label, row, col, col);
+    }
+  }
+  REQUIRE(islands.area == expected.area);
+  REQUIRE(islands.top == expected.top);
+  REQUIRE(islands.bottom == expected.bottom);
+  REQUIRE(islands.left == expected.left);
+  REQUIRE(islands.right == expected.right);
+  REQUIRE(islands.value == expected.value);
+}
+
+} // namespace
@@ -0,0 +1,40 @@
+#include "parallel_islands.hpp"
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+using namespace islands;
+
+TEST_CASE("exceptions of parallel tasks reach the caller", "[Parallel]")
+{
+  std::atomic<std::size_t> done{0};
+  auto const run = [&](unsigned threads) {
+    Details::run_tasks(threads, 1000, [&] {
+      return [&](std::size_t task) {
+        if (task == 37)
+          throw std::runtime_error{"task failed"};
+        done.fetch_add(1);
+      };
+    });
+  };
+  // a single thread stops at the failing task
+  REQUIRE_THROWS_AS(run(1), std::runtime_error);
+  REQUIRE(done.load() == 37);
+  REQUIRE_THROWS_AS(run(4), std::runtime_error);
+}
+
+TEST_CASE("islands spanning many bands are counted once", "[Parallel]")
+{
+  // zeros form a snake, crossing each band border a few times
+  DynamicMatrix<char> snake{std::vector<char>(40 * 9, 0), 40, 9};
+  for (std::size_t row = 0; row < snake.rows(); ++row)
+    for (std::size_t col = 0; col < snake.cols(); ++col)
+      snake(row, col) = col % 4 == 1 && row != (col % 8 == 1 ? 39 : 0);
+  REQUIRE(get_number_of_islands(snake) == get_number_of_islands(snake, Parallel{2, 3}));
+  REQUIRE(get_number_of_islands(snake, Parallel{0, 1}) == 3);
+}
+
+} // namespace
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "dynamic_matrix.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace islands
+{
+namespace test
+{
+
+// values from 0 to values - 1, fixed by the seed
+inline DynamicMatrix<int> random_matrix(std::size_t rows, std::size_t cols, int values, std::uint32_t seed)
+{
+  DynamicMatrix<int> result{std::vector<int>(rows * cols), rows, cols};
+  for (auto & cell : result.storage)
+  {
+    seed = seed * 1103515245u + 12345u;
+    cell = static_cast<int>((seed >> 16) % static_cast<std::uint32_t>(values));
+  }
+  return result;
+}
+
+} // namespace test
+} // namespace islands
@@ -0,0 +1,41 @@
+#include "connectivity.hpp"
+#include "dynamic_matrix.hpp"
+#include "scanline_islands.hpp"
+#include <catch2/catch.hpp>
+
+namespace
+{
+using namespace islands;
+
+TEST_CASE("runs are united across rows", "[Scanline]")
+{
+  DynamicMatrix<int> multiple {{
+    1, 1, 0, 1,
+    0, 1, 1, 1,
+    0, 0, 3, 3,
+    3, 3, 3, 3,
+    4, 3, 4, 3}, 5, 4};
+  REQUIRE(6 == get_number_of_islands<Scanline>(multiple));
+  // runs of the row above overlapping many runs below and the other way round
+  DynamicMatrix<char> comb {{
+    1, 1, 1, 1, 1, 1, 1,
+    1, 0, 1, 0, 1, 0, 1,
+    0, 0, 0, 0, 0, 0, 0,
+    0, 1, 1, 0, 1, 1, 0}, 4, 7};
+  REQUIRE(4 == get_number_of_islands<Scanline>(comb));
+
+}
+
+TEST_CASE("runs touching at corners are united by eight connectivity", "[Scanline]")
+{
+  // runs touching only at corners, in both values
+  DynamicMatrix<char> stairs {{
+    1, 0, 0, 1,
+    0, 1, 1, 0,
+    0, 0, 0, 1}, 3, 4};
+  REQUIRE(7 == get_number_of_islands<Scanline>(stairs));
+  REQUIRE(2 == get_number_of_islands<BasicScanline<EightConnected>>(stairs));
+
+}
+
+} // namespace
@@ -0,0 +1,32 @@
+#include "visited_bits.hpp"
+#include <catch2/catch.hpp>
+
+namespace
+{
+using namespace islands;
+
+TEST_CASE("unvisited cells are found across words", "[VisitedBits]")
+{
+  VisitedBits visited{200};
+  REQUIRE(visited.next_unvisited(0) == 0);
+  for (std::size_t cell = 0; cell < 150; ++cell)
+    visited.set(cell);
+  visited.set(151);
+  REQUIRE(visited.test(149));
+  REQUIRE(!visited.test(150));
+  REQUIRE(visited.next_unvisited(0) == 150);
+  REQUIRE(visited.next_unvisited(151) == 152);
+  for (std::size_t cell = 150; cell < 200; ++cell)
+    visited.set(cell);
+  REQUIRE(visited.next_unvisited(0) == 200);
+  REQUIRE(visited.next_unvisited(250) == 200);
+
+  visited.reset(64);
+  REQUIRE(visited.size() == 64);
+  REQUIRE(visited.next_unvisited(63) == 63);
+  visited.set(63);
+  REQUIRE(visited.next_unvisited(5) == 5);
+  REQUIRE(visited.next_unvisited(63) == 64);
+}
+
+} // namespace
@@ -0,0 +1,213 @@
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+
+/*
+ * Binary matrix file: a header followed by rows * cols cells in row major
+ * order, in the byte order of the machine that wrote them.
+ */
+namespace MatrixFile
+{
+
+enum class ElementType : std::uint32_t
+{
+  Int8 = 1,
+  UInt8,
+  Int16,
+  UInt16,
+  Int32,
+  UInt32,
+  Int64,
+  UInt64,
+  Float32,
+  Float64
+};
+
+template <typename T>
+constexpr ElementType element_type()
+{
+  static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "cells have to be numbers");
+  if constexpr (std::is_floating_point_v<T>)
+    return sizeof(T) == 4 ? ElementType::Float32 : ElementType::Float64;
+  else
+  {
+    constexpr auto signed_type = std::is_signed_v<T>;
+    switch (sizeof(T))
+    {
+      case 1: return signed_type ? ElementType::Int8 : ElementType::UInt8;
+      case 2: return signed_type ? ElementType::Int16 : ElementType::UInt16;
+      case 4: return signed_type ? ElementType::Int32 : ElementType::UInt32;
+      default: return signed_type ? ElementType::Int64 : ElementType::UInt64;
+    }
+  }
+}
+
+constexpr char magic[8] = {'M', 'A', 'T', 'R', 'I', 'X', '\0', '1'};
+
+// 32 bytes, so cells that follow are aligned for any arithmetic type
+struct Header
+{
+  char magic[8];
+  std::uint64_t rows;
+  std::uint64_t cols;
+  ElementType element_type;
+  std::uint32_t element_size;
+};
+
+/*
+ * Writes any matrix-like class of arithmetic cells to a file that
+ * MmapMatrix can map.
+ */
+template <typename Matrix>
+void write(char const * path, Matrix const & matrix)
+{
+  using T = std::decay_t<decltype(matrix(0, 0))>;
+  Header header{{}, matrix.rows(), matrix.cols(), element_type<T>(), static_cast<std::uint32_t>(sizeof(T))};
+  std::memcpy(header.magic, magic, sizeof(magic));
+  auto const file = std::fopen(path, "wb");
+  if (file == nullptr)
+    throw std::system_error{errno, std::generic_category(), path};
+  auto ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+  for (std::size_t row = 0; ok && row < matrix.rows(); ++row)
+  {
+    for (std::size_t col = 0; ok && col < matrix.cols(); ++col)
+    {
+      T const cell = matrix(row, col);
+      ok = std::fwrite(&cell, sizeof(cell), 1, file) == 1;
+    }
+  }
+  ok = std::fclose(file) == 0 && ok;
+  if (!ok)
+    throw std::system_error{errno, std::generic_category(), path};
+}
+
+} // namespace MatrixFile
+
+/*
+ * Read-only view of a binary matrix file (see MatrixFile), mapped to memory
+ * rather than read, so cells are loaded by the OS on first access and never
+ * copied. Throws if the file can't be mapped, or doesn't hold cells of type T.
+ */
+template <typename T>
+class MmapMatrix
+{
+public:
+  // expected access pattern, passed on to madvise
+  enum class Access
+  {
+    Normal = MADV_NORMAL,
+    Sequential = MADV_SEQUENTIAL,
+    Random = MADV_RANDOM,
+    WillNeed = MADV_WILLNEED
+  };
+
+  explicit MmapMatrix(char const * path, Access access = Access::Normal)
+  {
+    auto const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      throw std::system_error{errno, std::generic_category(), path};
+    struct stat status;
+    if (::fstat(fd, &status) != 0)
+      fail(fd, path);
+    length = static_cast<std::size_t>(status.st_size);
+    if (length < sizeof(MatrixFile::Header))
+    {
+      ::close(fd);
+      throw std::runtime_error{std::string{path} + ": not a matrix file"};
+    }
+    mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED)
+      fail(fd, path);
+    ::close(fd);
+
+    MatrixFile::Header header;
+    std::memcpy(&header, mapping, sizeof(header));
+    rows_ = header.rows;
+    cols_ = header.cols;
+    if (std::memcmp(header.magic, MatrixFile::magic, sizeof(header.magic)) != 0
+        || header.element_type != MatrixFile::element_type<T>() || header.element_size != sizeof(T)
+        || (cols_ != 0 && (length - sizeof(header)) / sizeof(T) / cols_ < rows_))
+    {
+      ::munmap(mapping, length);
+      throw std::runtime_error{std::string{path} + ": not a matrix file of requested cell type"};
+    }
+    cells = static_cast<T const *>(static_cast<void const *>(static_cast<char const *>(mapping) + sizeof(header)));
+    advise(access);
+  }
+
+  ~MmapMatrix()
+  {
+    if (mapping != nullptr)
+      ::munmap(mapping, length);
+  }
+
+  MmapMatrix(MmapMatrix && other) noexcept
+  : mapping{std::exchange(other.mapping, nullptr)}
+  , length{other.length}
+  , cells{other.cells}
+  , rows_{other.rows_}
+  , cols_{other.cols_}
+  {}
+
+  MmapMatrix & operator=(MmapMatrix && other) noexcept
+  {
+    std::swap(mapping, other.mapping);
+    std::swap(length, other.length);
+    std::swap(cells, other.cells);
+    std::swap(rows_, other.rows_);
+    std::swap(cols_, other.cols_);
+    return *this;
+  }
+
+  T const & operator()(std::size_t row, std::size_t col) const
+  {
+    return cells[cols_ * row + col];
+  }
+
+  std::size_t rows() const
+  {
+    return rows_;
+  }
+
+  std::size_t cols() const
+  {
+    return cols_;
+  }
+
+  T const * data() const
+  {
+    return cells;
+  }
+
+  // hints the OS how the cells will be read, it's only a hint so failure is
+  // ignored
+  void advise(Access access) const
+  {
+    ::madvise(mapping, length, static_cast<int>(access));
+  }
+
+private:
+  [[noreturn]] static void fail(int fd, char const * path)
+  {
+    auto const error = errno;
+    ::close(fd);
+    throw std::system_error{error, std::generic_category(), path};
+  }
+
+  void * mapping = nullptr;
+  std::size_t length = 0;
+  T const * cells = nullptr;
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+};
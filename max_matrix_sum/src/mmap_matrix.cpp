@@ -0,0 +1 @@
+#include "mmap_matrix.hpp"
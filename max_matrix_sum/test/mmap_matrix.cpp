@@ -0,0 +1,83 @@
+#include "array2d.hpp"
+#include "matrix_type_traits.hpp"
+#include "max_sum_solution.hpp"
+#include "mmap_matrix.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+namespace
+{
+
+// removes the file when going out of scope
+struct TemporaryFile
+{
+  explicit TemporaryFile(char const * name)
+  : path{(std::filesystem::temp_directory_path() / name).string()}
+  {}
+  ~TemporaryFile()
+  {
+    std::remove(path.c_str());
+  }
+
+  std::string path;
+};
+
+template <typename T, typename = MatrixTypeTraits::is_matrix_of_arithmetic_types<T>>
+constexpr bool is_matrix()
+{
+  return true;
+}
+
+} // namespace
+
+TEST_CASE("Mapped matrix holds written cells", "[MmapMatrix]")
+{
+  STATIC_REQUIRE(is_matrix<MmapMatrix<int>>());
+  STATIC_REQUIRE(is_matrix<MmapMatrix<double>>());
+
+  TemporaryFile const file{"mmap_matrix_cells.bin"};
+  auto const written = Array2d<std::int16_t, 2u, 3u>{{1, -2, 3, 4, 5, -6}};
+  MatrixFile::write(file.path.c_str(), written);
+  MmapMatrix<std::int16_t> const mapped{file.path.c_str(), MmapMatrix<std::int16_t>::Access::Sequential};
+  REQUIRE(mapped.rows() == 2);
+  REQUIRE(mapped.cols() == 3);
+  for (std::size_t row = 0; row < 2; ++row)
+    for (std::size_t col = 0; col < 3; ++col)
+      REQUIRE(mapped(row, col) == written(row, col));
+  REQUIRE(mapped.data() == &mapped(0, 0));
+}
+
+TEST_CASE("Mapped matrix may have no columns", "[MmapMatrix]")
+{
+  TemporaryFile const file{"mmap_matrix_no_cols.bin"};
+  MatrixFile::write(file.path.c_str(), Array2d<int, 5u, 0u>{});
+  MmapMatrix<int> const mapped{file.path.c_str()};
+  REQUIRE(mapped.rows() == 5);
+  REQUIRE(mapped.cols() == 0);
+}
+
+TEST_CASE("Max sum is found in a mapped matrix", "[MmapMatrix]")
+{
+  TemporaryFile const file{"mmap_matrix_max_sum.bin"};
+  auto const problem = Array2d<int, 3u, 4u>{{1, 2, 3, 4, 8, 7, 6, 5, 9, 1, 1, 1}};
+  MatrixFile::write(file.path.c_str(), problem);
+  MmapMatrix<int> mapped{file.path.c_str()};
+  REQUIRE(MaxSum::solve(mapped) == MaxSum::solve(problem));
+  REQUIRE(MaxSum::solve_with_path(mapped) == MaxSum::solve_with_path(problem));
+
+  auto moved = std::move(mapped);
+  REQUIRE(MaxSum::solve(moved) == MaxSum::solve(problem));
+}
+
+TEST_CASE("Mapping fails for files of other cell types", "[MmapMatrix]")
+{
+  TemporaryFile const file{"mmap_matrix_types.bin"};
+  MatrixFile::write(file.path.c_str(), Array2d<float, 1u, 2u>{{1.5f, 2.5f}});
+  REQUIRE_NOTHROW(MmapMatrix<float>{file.path.c_str()});
+  REQUIRE_THROWS_AS(MmapMatrix<int>{file.path.c_str()}, std::runtime_error);
+  REQUIRE_THROWS_AS(MmapMatrix<double>{file.path.c_str()}, std::runtime_error);
+  REQUIRE_THROWS_AS(MmapMatrix<int>{"/nonexistent/matrix.bin"}, std::system_error);
+}
@@ -0,0 +1,86 @@
+#include "corpora.hpp"
+#include <cstdint>
+
+namespace regexes
+{
+namespace bench
+{
+
+namespace
+{
+
+// small xorshift generator, the same sequence on every platform
+class Random
+{
+public:
+  std::uint32_t next()
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return static_cast<std::uint32_t>(state >> 32);
+  }
+
+  std::size_t below(std::size_t bound)
+  {
+    return next() % bound;
+  }
+
+private:
+  std::uint64_t state = 0x9e3779b97f4a7c15ull;
+};
+
+std::string word(Random & random)
+{
+  std::string result;
+  for (auto length = 2 + random.below(8); length > 0; --length)
+    result += static_cast<char>('a' + random.below(26));
+  return result;
+}
+
+} // namespace
+
+std::string log_lines(std::size_t size)
+{
+  static char const * const levels[] = {"INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR"};
+  static char const * const services[] = {"auth", "billing", "gateway", "search", "storage"};
+  Random random;
+  std::string result;
+  while (result.size() < size)
+  {
+    auto const seconds = result.size() / 97;
+    result += "2024-03-";
+    result += std::to_string(10 + seconds / 86400 % 20) + "T" + std::to_string(10 + seconds / 3600 % 14) + ":" +
+              std::to_string(10 + seconds / 60 % 50) + ":" + std::to_string(10 + seconds % 50);
+    result += " host-" + std::to_string(random.below(64));
+    result += std::string{" "} + services[random.below(5)] + "[" + std::to_string(1000 + random.below(9000)) + "]:";
+    result += std::string{" level="} + levels[random.below(6)] + " msg=";
+    for (auto words = 1 + random.below(6); words > 0; --words)
+      result += word(random) + " ";
+    result += "id=" + std::to_string(random.below(100000)) + "\n";
+  }
+  result.resize(size);
+  return result;
+}
+
+std::string random_text(std::size_t size)
+{
+  Random random;
+  std::string result;
+  while (result.size() < size)
+    result += word(random) + " ";
+  result.resize(size);
+  return result;
+}
+
+std::string random_chars(std::size_t size, std::string const & alphabet)
+{
+  Random random;
+  std::string result(size, '\0');
+  for (auto & c : result)
+    c = alphabet[random.below(alphabet.size())];
+  return result;
+}
+
+} // namespace bench
+} // namespace regexes
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace regexes
+{
+namespace bench
+{
+
+/*
+ * Generated inputs, deterministic for a given size so that runs can be
+ * compared with each other.
+ */
+
+// newline separated lines of a service log, with an ERROR line every so often
+std::string log_lines(std::size_t size);
+
+// lowercase words separated by spaces
+std::string random_text(std::size_t size);
+
+// uniformly random chars from the given alphabet
+std::string random_chars(std::size_t size, std::string const & alphabet);
+
+} // namespace bench
+} // namespace regexes
@@ -0,0 +1,323 @@
+#include "allocations.hpp"
+#include "batch.hpp"
+#include "compiled_pattern.hpp"
+#include "corpora.hpp"
+#include "flat_pattern.hpp"
+#include "lazy_dfa.hpp"
+#include "matcher.hpp"
+#include "nfa_simulation.hpp"
+#include "pattern_parser.hpp"
+#include "search.hpp"
+#include "shift_and.hpp"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using namespace regexes;
+using namespace regexes::bench;
+using namespace ::bench;
+
+/*
+ * Results are printed one per line as tab separated suite, case, engine,
+ * metric and value, so that runs can be diffed or joined on the first four.
+ */
+void report(char const * suite, std::string const & name, char const * engine, char const * metric, double value)
+{
+  std::printf("%s\t%s\t%s\t%s\t%.4g\n", suite, name.c_str(), engine, metric, value);
+}
+
+struct Measurement
+{
+  double ns_per_op;
+  double allocations_per_op;
+};
+
+// repeats op for at least 50ms
+template <typename Op>
+Measurement measure(Op && op)
+{
+  using Clock = std::chrono::steady_clock;
+  std::size_t repetitions = 0;
+  std::size_t results = 0;
+  reset_allocations();
+  auto const start = Clock::now();
+  auto now = start;
+  while (repetitions == 0 || now - start < std::chrono::milliseconds{50})
+  {
+    results += op() ? 1 : 0;
+    ++repetitions;
+    now = Clock::now();
+  }
+  std::chrono::duration<double, std::nano> const elapsed = now - start;
+  auto const allocated = allocations();
+  if (results != 0 && results != repetitions)
+    std::fprintf(stderr, "inconsistent results\n");
+  auto const ops = static_cast<double>(repetitions);
+  return {elapsed.count() / ops, static_cast<double>(allocated.count) / ops};
+}
+
+/*
+ * ns per input byte and allocations per match of an engine set up by make,
+ * and peak heap usage of setting it up and matching once.
+ */
+template <typename Make, typename Run>
+void bench_engine(char const * suite, std::string const & name, char const * engine, std::string const & input,
+                  Make && make, Run && run)
+{
+  reset_allocations();
+  {
+    auto const once = make();
+    run(once, input);
+  }
+  auto const peak = allocations().peak_bytes;
+  auto const prepared = make();
+  auto const measurement = measure([&] { return run(prepared, input); });
+  report(suite, name, engine, "ns_per_byte", measurement.ns_per_op / static_cast<double>(input.size()));
+  report(suite, name, engine, "allocations_per_match", measurement.allocations_per_op);
+  report(suite, name, engine, "peak_bytes", static_cast<double>(peak));
+}
+
+struct NfaEngine
+{
+  explicit NfaEngine(Pattern const & pattern)
+  : program{pattern}
+  , simulation{program}
+  {}
+
+  NfaProgram program;
+  NfaSimulation simulation;
+};
+
+struct Case
+{
+  char const * corpus;
+  char const * pattern;
+  std::string const & input;
+  bool small_dfa; // determinization doesn't blow up
+};
+
+/*
+ * Whole string matching with each engine: per-call matches on Token and
+ * FlatToken patterns (engine set up on each call), and prepared engines,
+ * Matcher being the one matches picks.
+ */
+void match_suite(Case const & c)
+{
+  auto const name = std::string{c.corpus} + "/" + c.pattern;
+  auto const pattern = tokenize(c.pattern);
+  bench_engine("match", name, "token", c.input, [&] { return tokenize(c.pattern); },
+               [](Pattern const & tokens, std::string const & input) { return matches(input, tokens); });
+  bench_engine("match", name, "flat", c.input, [&] { return tokenize_flat(c.pattern); },
+               [](FlatPattern const & tokens, std::string const & input) { return matches(input, tokens); });
+  bench_engine("match", name, "matcher", c.input, [&] { return Matcher{pattern}; },
+               [](Matcher const & engine, std::string const & input) { return engine.matches(input); });
+  if (ShiftAnd<64>::fits(pattern))
+    bench_engine("match", name, "shift_and", c.input, [&] { return ShiftAnd<64>{pattern}; },
+                 [](ShiftAnd<64> const & engine, std::string const & input) { return engine.matches(input); });
+  else if (ShiftAnd<256>::fits(pattern))
+    bench_engine("match", name, "shift_and", c.input, [&] { return ShiftAnd<256>{pattern}; },
+                 [](ShiftAnd<256> const & engine, std::string const & input) { return engine.matches(input); });
+  bench_engine("match", name, "nfa", c.input, [&] { return std::make_unique<NfaEngine>(pattern); },
+               [](std::unique_ptr<NfaEngine> const & engine, std::string const & input) {
+                 return engine->simulation.matches(input);
+               });
+  bench_engine("match", name, "lazy_dfa", c.input, [&] { return std::make_unique<LazyDfa>(pattern); },
+               [](std::unique_ptr<LazyDfa> const & engine, std::string const & input) {
+                 return engine->matches(input);
+               });
+  if (c.small_dfa)
+    bench_engine("match", name, "dfa", c.input, [&] { return CompiledPattern{pattern}; },
+                 [](CompiledPattern const & engine, std::string const & input) { return engine.matches(input); });
+}
+
+/*
+ * Speed of the lazy DFA against the size of its state cache, on a pattern
+ * whose full DFA has 2^17 states.
+ */
+void lazy_dfa_suite(std::string const & input)
+{
+  auto const text = ".*a.{16}b";
+  auto const pattern = tokenize(text);
+  for (std::size_t max_states = 1u << 6; max_states <= (1u << 16); max_states <<= 2)
+  {
+    auto const name = std::string{"ab/"} + text + "/max_states=" + std::to_string(max_states);
+    LazyDfa dfa{pattern, max_states};
+    auto const measurement = measure([&] { return dfa.matches(input); });
+    auto const stats = dfa.stats();
+    auto const transitions = static_cast<double>(stats.hits + stats.misses);
+    report("lazy_dfa", name, "lazy_dfa", "ns_per_byte", measurement.ns_per_op / static_cast<double>(input.size()));
+    report("lazy_dfa", name, "lazy_dfa", "hit_rate", transitions > 0 ? static_cast<double>(stats.hits) / transitions : 0);
+    report("lazy_dfa", name, "lazy_dfa", "flushes", static_cast<double>(stats.flushes));
+    report("lazy_dfa", name, "lazy_dfa", "fallbacks", static_cast<double>(stats.fallbacks));
+  }
+}
+
+// leftmost-longest search, with the engine set up on each call
+void search_suite(char const * corpus, char const * text, std::string const & input)
+{
+  auto const pattern = tokenize(text);
+  bench_engine("search", std::string{corpus} + "/" + text, "find", input, [&] { return 0; },
+               [&](int, std::string const & string) { return find(string, pattern).has_value(); });
+}
+
+// parsing cost, per byte of the pattern
+void tokenize_suite(char const * text)
+{
+  std::string const pattern = text;
+  auto const bytes = static_cast<double>(pattern.size());
+  auto const tokens = measure([&] { return !tokenize(pattern).empty(); });
+  report("tokenize", pattern, "token", "ns_per_byte", tokens.ns_per_op / bytes);
+  report("tokenize", pattern, "token", "allocations_per_tokenize", tokens.allocations_per_op);
+  alignas(std::max_align_t) static char buffer[1u << 16];
+  std::pmr::monotonic_buffer_resource arena{buffer, sizeof(buffer)};
+  auto const in_arena = measure([&] {
+    auto const result = !tokenize(pattern, &arena).empty();
+    arena.release();
+    return result;
+  });
+  report("tokenize", pattern, "token_arena", "ns_per_byte", in_arena.ns_per_op / bytes);
+  report("tokenize", pattern, "token_arena", "allocations_per_tokenize", in_arena.allocations_per_op);
+  auto const flat = measure([&] { return !tokenize_flat(pattern).empty(); });
+  report("tokenize", pattern, "flat", "ns_per_byte", flat.ns_per_op / bytes);
+  report("tokenize", pattern, "flat", "allocations_per_tokenize", flat.allocations_per_op);
+}
+
+/*
+ * Guards against superlinear blow up on adversarial inputs: per byte cost of
+ * each engine must not grow with input length.
+ */
+template <typename Make, typename Run>
+bool scales_linearly(std::string const & name, char const * engine, char input_char, Make && make, Run && run)
+{
+  bool result = true;
+  double first = 0;
+  auto const prepared = make();
+  for (std::size_t n = 1u << 12; n <= (1u << 18); n <<= 3)
+  {
+    std::string const input(n, input_char);
+    auto const cost = measure([&] { return run(prepared, input); }).ns_per_op / static_cast<double>(n);
+    report("scaling", name + "/n=" + std::to_string(n), engine, "ns_per_byte", cost);
+    if (first == 0)
+      first = cost;
+    else if (cost > 4 * first)
+      result = false;
+  }
+  return result;
+}
+
+bool scaling_suite()
+{
+  std::string text;
+  for (int i = 0; i < 60; ++i)
+    text += "a*";
+  auto const pattern = tokenize(text + "b");
+  bool result = true;
+  result &= scales_linearly("(a*)^60b", "nfa", 'a', [&] { return std::make_unique<NfaEngine>(pattern); },
+                            [](std::unique_ptr<NfaEngine> const & engine, std::string const & input) {
+                              return engine->simulation.matches(input);
+                            });
+  result &= scales_linearly("(a*)^60b", "shift_and", 'a', [&] { return ShiftAnd<64>{pattern}; },
+                            [](ShiftAnd<64> const & engine, std::string const & input) {
+                              return engine.matches(input);
+                            });
+  result &= scales_linearly("(a*)^60b", "dfa", 'a', [&] { return CompiledPattern{pattern}; },
+                            [](CompiledPattern const & engine, std::string const & input) {
+                              return engine.matches(input);
+                            });
+  // bounded repetition is counted per token rather than unrolled
+  for (auto bounded : {"[a-z]{1,200}b", ".*a{1,1000}b", "[^b]{10,}b", "a{0,500}a{500}b"})
+    result &= scales_linearly(bounded, "token", 'a', [&] { return tokenize(bounded); },
+                              [](Pattern const & tokens, std::string const & input) {
+                                return matches(input, tokens);
+                              });
+  return result;
+}
+
+// one pattern over many short records, one by one and in batches
+void batch_suite()
+{
+  std::vector<std::string> strings;
+  for (std::size_t i = 0; i < (1u << 20); ++i)
+  {
+    std::string record = "id=" + std::to_string(i * 7919) + ";status=";
+    record += (i % 5 == 0) ? "error" : "ok";
+    strings.push_back(record + ";payload=" + std::string(16 + i % 32, 'x'));
+  }
+  std::vector<std::string_view> const inputs(strings.begin(), strings.end());
+  auto const text = "id=.*;status=error;.*";
+  auto const pattern = tokenize(text);
+  auto const records = static_cast<double>(inputs.size());
+
+  auto const one_by_one = measure([&] {
+    std::size_t matched = 0;
+    for (auto input : inputs)
+      matched += matches(input, pattern);
+    return matched == inputs.size() / 5 + 1;
+  });
+  report("batch", text, "matches", "records_per_second", records * 1e9 / one_by_one.ns_per_op);
+  auto const single = measure([&] { return !matches_batch(pattern, inputs, 1).empty(); });
+  report("batch", text, "batch_x1", "records_per_second", records * 1e9 / single.ns_per_op);
+  if (std::thread::hardware_concurrency() > 1)
+  {
+    auto const all = measure([&] { return !matches_batch(pattern, inputs, 0).empty(); });
+    report("batch", text, "batch_all_threads", "records_per_second", records * 1e9 / all.ns_per_op);
+  }
+}
+
+} // namespace
+
+/*
+ * Throughput, allocations and peak memory of each engine on generated
+ * corpora, parsing cost, and scaling guards on adversarial inputs (the exit
+ * status is 1 if any of those grows superlinearly).
+ */
+int main()
+{
+  auto const log = log_lines(1u << 20);
+  auto const text = random_text(1u << 20);
+  auto const ab = random_chars(1u << 16, "ab");
+  std::string const digits = std::string(64, '7') + "x";
+  std::string const letters = "azbzczdzezfzgz";
+  std::string const many_a(1u << 16, 'a');
+  std::string pathological;
+  for (int i = 0; i < 30; ++i)
+    pathological += "a*";
+  pathological += "b";
+
+  Case const cases[] = {
+    {"log", ".*level=ERROR msg=[a-z ]*id=[0-9]+.*", log, false},
+    {"log", "[ -~\n]*", log, true},
+    {"text", "[a-z ]*", text, true},
+    {"text", ".*[qxz]{3}.*", text, true},
+    {"short", "[0-9][0-9]*.*x", digits, true},
+    {"short", "a.b.c.d.e.f.g.", letters, true},
+    {"ab", ".*a.{16}b", ab, false},
+    {"a^n", pathological.c_str(), many_a, true},
+    {"a^n", ".*a{1,1000}b", many_a, false},
+  };
+
+  std::printf("suite\tcase\tengine\tmetric\tvalue\n");
+  for (auto const & c : cases)
+  {
+    tokenize_suite(c.pattern);
+    match_suite(c);
+  }
+  lazy_dfa_suite(ab);
+  search_suite("log", "level=FATAL", log);
+  search_suite("log", "level=ERROR msg=[a-z]+ [a-z]+ id=99[0-9]{3}", log);
+  search_suite("text", "[qxz]{4}", text);
+  search_suite("a^n", ".*a{1,1000}b", many_a);
+  batch_suite();
+  if (!scaling_suite())
+  {
+    std::fprintf(stderr, "per byte cost grows with input length\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "pattern_parser.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <vector>
+
+namespace regexes
+{
+
+/*
+ * Allocator of cache line (64 byte) aligned memory.
+ */
+template <typename T>
+struct CacheLineAllocator
+{
+  using value_type = T;
+
+  CacheLineAllocator() = default;
+
+  template <typename U>
+  CacheLineAllocator(CacheLineAllocator<U> const &)
+  {}
+
+  T * allocate(std::size_t count)
+  {
+    return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t{64}));
+  }
+
+  void deallocate(T * pointer, std::size_t)
+  {
+    ::operator delete(pointer, std::align_val_t{64});
+  }
+};
+
+template <typename T, typename U>
+bool operator==(CacheLineAllocator<T> const &, CacheLineAllocator<U> const &)
+{
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(CacheLineAllocator<T> const &, CacheLineAllocator<U> const &)
+{
+  return false;
+}
+
+using Bitmap = std::vector<std::uint64_t, CacheLineAllocator<std::uint64_t>>;
+
+/*
+ * Matches every one of count inputs against the pattern, setting bit i % 64
+ * of bitmap[i / 64] iff inputs[i] matches, bitmap has to hold
+ * (count + 63) / 64 words. The engine is set up once, inputs are handed out
+ * to the workers in chunks of 512, so that each worker writes whole cache
+ * lines if the caller aligns bitmap to 64 bytes. threads == 0 uses all
+ * hardware threads.
+ */
+void matches_batch (Pattern const & pattern, std::string_view const * inputs, std::size_t count,
+                    std::uint64_t * bitmap, unsigned threads = 1);
+
+// same, returning a bitmap aligned to 64 bytes
+Bitmap matches_batch (Pattern const & pattern, std::vector<std::string_view> const & inputs,
+                      unsigned threads = 1);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "pattern_parser.hpp"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace regexes
+{
+
+/*
+ * Pattern lowered to a deterministic automaton, with transitions stored in a
+ * dense [state][byte] table. Matching does a single table lookup per input
+ * byte and never allocates.
+ * The automaton is built by subset construction from the Glushkov automaton
+ * of the pattern, so the number of states may grow exponentially for patterns
+ * with many repeated wildcards or charsets followed by further tokens.
+ */
+class CompiledPattern
+{
+public:
+  explicit CompiledPattern(Pattern const & pattern);
+
+  bool matches(std::string_view string) const;
+
+  std::size_t states() const;
+
+private:
+  using State = std::uint32_t;
+  std::vector<State> transitions;
+  std::vector<bool> accepting;
+};
+
+bool matches (std::string_view string, CompiledPattern const & pattern);
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "pattern_parser.hpp"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace regexes
+{
+
+/*
+ * Value type counterpart of Token. The matcher and both satisfied policies
+ * are kept inline as tags (with an inline 256 bit bitmap for charsets), so
+ * a FlatPattern is one contiguous array and matching dispatches on the tags
+ * with a switch instead of chasing pointers to virtual objects.
+ * Semantics of the tags follow CharMatcher, Charset, Wildcard and
+ * SatisfiedAfterMatch, AlwaysSatisfied, NeverSatisfied, SatisfiedAfterMatches
+ * respectively, the count of the latter is kept next to the tags.
+ * Anchors become charsets accepting nothing, FlatPatterns are only matched
+ * whole, where they make no difference.
+ */
+class FlatToken
+{
+public:
+  enum class Kind : std::uint8_t
+  {
+    Char,
+    Charset,
+    Wildcard
+  };
+
+  enum class Policy : std::uint8_t
+  {
+    AfterMatch,
+    Always,
+    Never,
+    AfterMatches
+  };
+
+  // tokens matched from min_matches to max_matches (possibly unbounded) times
+  static FlatToken character(char value, std::size_t min_matches, std::size_t max_matches);
+  static FlatToken charset(ByteSet const & accepted_chars, std::size_t min_matches, std::size_t max_matches);
+  static FlatToken wildcard(std::size_t min_matches, std::size_t max_matches);
+
+  bool accepts(char c) const
+  {
+    switch (kind)
+    {
+    case Kind::Char:
+      return c == value;
+    case Kind::Charset:
+    {
+      auto const byte = static_cast<unsigned char>(c);
+      return (bitmap[byte / 64] >> (byte % 64)) & 1u;
+    }
+    case Kind::Wildcard:
+      return true;
+    }
+    return false;
+  }
+
+  bool matched(std::size_t times_matched) const
+  {
+    return satisfied(matched_cryterium, matched_count, times_matched);
+  }
+
+  bool exhausted(std::size_t times_matched) const
+  {
+    return satisfied(exhausted_cryterium, exhausted_count, times_matched);
+  }
+
+  ByteSet accepted() const;
+  std::size_t min_matches() const;
+  std::size_t max_matches() const;
+
+private:
+  FlatToken(Kind kind, std::size_t min_matches, std::size_t max_matches);
+
+  static bool satisfied(Policy policy, std::size_t count, std::size_t times_matched)
+  {
+    switch (policy)
+    {
+    case Policy::AfterMatch:
+      return times_matched > 0;
+    case Policy::Always:
+      return true;
+    case Policy::Never:
+      return false;
+    case Policy::AfterMatches:
+      return times_matched >= count;
+    }
+    return false;
+  }
+
+  Kind kind;
+  Policy matched_cryterium;
+  Policy exhausted_cryterium;
+  std::size_t matched_count;
+  std::size_t exhausted_count;
+  union
+  {
+    char value;
+    std::uint64_t bitmap[4];
+  };
+};
+
+using FlatPattern = std::vector<FlatToken>;
+
+FlatPattern tokenize_flat (std::string_view pattern);
+
+FlatToken flatten (Token const & token);
+
+FlatPattern flatten (Pattern const & pattern);
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "pattern_parser.hpp"
+#include <memory>
+#include <string_view>
+
+namespace regexes
+{
+
+/*
+ * Deterministic automaton of a pattern built lazily, while matching: a state
+ * (a set of NFA states) and its transition on a byte are only computed when
+ * the input first gets there, and kept in a cache of at most max_states
+ * states (at least 4). Bytes accepted by the same tokens share transitions,
+ * so a state takes 4 bytes per such class besides its NFA state set.
+ * A full cache is flushed and rebuilt from the current state, unless the
+ * automaton consumed fewer than 10 bytes per state since the previous flush,
+ * in which case caching doesn't pay off and the string is matched by NFA
+ * simulation instead.
+ * Matching updates the cache, so an instance must not be used from many
+ * threads at once.
+ */
+class LazyDfa
+{
+public:
+  struct Stats
+  {
+    std::size_t hits;      // transitions taken from the cache
+    std::size_t misses;    // transitions computed
+    std::size_t flushes;
+    std::size_t fallbacks; // strings matched by NFA simulation
+  };
+
+  explicit LazyDfa(Pattern const & pattern, std::size_t max_states = 2048);
+  ~LazyDfa();
+  LazyDfa(LazyDfa &&) noexcept;
+  LazyDfa & operator=(LazyDfa &&) noexcept;
+
+  bool matches(std::string_view string);
+
+  Stats stats() const;
+
+  // number of states cached now
+  std::size_t states() const;
+
+  struct Cache;
+
+private:
+  std::unique_ptr<Cache> cache;
+};
+
+bool matches (std::string_view string, LazyDfa & pattern);
+
+}
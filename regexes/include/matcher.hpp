@@ -2,14 +2,43 @@
 #include <string_view>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 
 namespace regexes
 {
 
 struct Token;
+class FlatToken;
 
+// pattern text is tokenized and its engine set up once, through the cache
 bool matches (std::string_view string, std::string_view pattern);
 
-bool matches (std::string_view string, std::vector<Token> const & pattern);
+// one-shot: sets the engine up on every call, use Matcher to match many strings
+bool matches (std::string_view string, std::pmr::vector<Token> const & pattern);
+
+// one-shot: sets the engine up on every call, use Matcher to match many strings
+bool matches (std::string_view string, std::vector<FlatToken> const & pattern);
+
+/*
+ * Engine matches picks for a pattern, set up once: the prefilter, then
+ * Shift-And when the pattern has at most 256 positions and NFA simulation
+ * otherwise. Keeps no reference to the pattern and can be shared between
+ * threads.
+ */
+class Matcher
+{
+public:
+  explicit Matcher(std::pmr::vector<Token> const & pattern);
+  explicit Matcher(std::vector<FlatToken> const & pattern);
+  Matcher(Matcher &&) noexcept;
+  Matcher & operator=(Matcher &&) noexcept;
+  ~Matcher();
+
+  bool matches(std::string_view string) const;
+
+private:
+  struct Engine;
+  std::unique_ptr<Engine const> engine;
+};
 
 }
@@ -0,0 +1,76 @@
+#pragma once
+#include "matcher.hpp"
+#include "pattern_parser.hpp"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace regexes
+{
+
+/*
+ * Bounded cache of tokenized patterns and their matchers keyed by pattern
+ * text, evicting the least recently used one when full. Safe to use from many
+ * threads, patterns are shared with the callers, so an evicted one stays valid
+ * while in use.
+ */
+class PatternCache
+{
+public:
+  struct Stats
+  {
+    std::size_t hits;
+    std::size_t misses;
+    std::size_t evictions;
+  };
+
+  explicit PatternCache(std::size_t capacity);
+
+  // tokenized pattern, taken from the cache if it's there
+  std::shared_ptr<Pattern const> get(std::string_view pattern);
+  // matcher of the pattern, set up with it and cached along
+  std::shared_ptr<Matcher const> matcher(std::string_view pattern);
+
+  Stats stats() const;
+  std::size_t size() const;
+  std::size_t capacity() const;
+  void set_capacity(std::size_t capacity);
+  void clear();
+
+private:
+  struct Compiled
+  {
+    explicit Compiled(Pattern && tokens);
+
+    Pattern pattern;
+    Matcher matcher;
+  };
+  struct Entry
+  {
+    std::string text;
+    std::shared_ptr<Compiled const> compiled;
+  };
+  using Entries = std::list<Entry>;
+
+  std::shared_ptr<Compiled const> find_or_compile(std::string_view text);
+  // moves found entry to the front, requires mutex to be held
+  std::shared_ptr<Compiled const> lookup(std::string_view text);
+  // requires mutex to be held
+  void evict_over_capacity();
+
+  mutable std::mutex mutex;
+  Entries entries; // most recently used first
+  std::unordered_map<std::string_view, Entries::iterator> index; // keys view texts of entries
+  std::size_t capacity_;
+  Stats stats_{};
+};
+
+/*
+ * Cache used when matching against pattern text.
+ */
+PatternCache & default_pattern_cache();
+
+}
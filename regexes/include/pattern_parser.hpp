@@ -1,32 +1,82 @@
-#include <vector>
+#pragma once
+#include <bitset>
+#include <limits>
 #include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
 
 namespace regexes
 {
 
-struct Matcher;
-struct SatisfiedPolicy;
+/*
+ * Set of bytes, indexed by their unsigned char value.
+ */
+using ByteSet = std::bitset<256>;
+
+/*
+ * Repetition bound of tokens which can be matched any number of times.
+ */
+constexpr std::size_t unbounded = std::numeric_limits<std::size_t>::max();
+
+/*
+ * Largest m and n of a {m,n} repetition, as in RE2. Engines keep state per
+ * count, braces with larger ones don't form a repetition.
+ */
+constexpr std::size_t max_repetition = 1000;
+
+/*
+ * Zero-width assertion made by a token, tokens of ^ and $ match no chars and
+ * only assert being at the start or the end of the string.
+ */
+enum class Anchor
+{
+  None,
+  Start,
+  End
+};
 
 struct Token
 {
+  struct Impl;
+  // destroys the Impl and gives its memory back to the resource it came from
+  struct ImplDelete
+  {
+    std::pmr::memory_resource * resource;
+    void operator()(Impl * impl) const;
+  };
+
   ~Token();
   Token(Token&&) noexcept = default;
   Token& operator=(Token&&) noexcept = default;
   Token(Token const &) = delete;
   Token& operator=(Token const&) = delete;
-  Token(std::unique_ptr<Matcher>&& matcher,
-        std::unique_ptr<SatisfiedPolicy>&& matched_cryterium,
-        std::unique_ptr<SatisfiedPolicy>&& exhausted_cryterium);
+  Token(std::unique_ptr<Impl, ImplDelete>&& impl);
 
   bool accepts(char c) const;
   bool matched(std::size_t times_matched) const;
   bool exhausted(std::size_t times_matched) const;
+
+  // Introspection used when lowering tokens to automata
+  ByteSet accepted() const;
+  // smallest times_matched for which matched() holds
+  std::size_t min_matches() const;
+  // smallest times_matched for which exhausted() holds, or unbounded
+  std::size_t max_matches() const;
+  Anchor anchor() const;
 private:
-  struct Impl;
-  std::unique_ptr<Impl> pImpl;
+  std::unique_ptr<Impl, ImplDelete> pImpl;
 };
 
-using Pattern = std::vector<Token>;
-Pattern tokenize (std::string_view pattern);
+using Pattern = std::pmr::vector<Token>;
+
+/*
+ * All memory of the pattern, the token array included, is allocated from the
+ * resource, so that with a monotonic arena a whole pattern takes a few
+ * contiguous blocks, released at once with the arena. Throws
+ * std::invalid_argument on a reversed range like [z-a].
+ */
+Pattern tokenize (std::string_view pattern,
+                  std::pmr::memory_resource * resource = std::pmr::get_default_resource());
 
 }
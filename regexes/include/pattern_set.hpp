@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace regexes
+{
+
+/*
+ * Many patterns matched against an input in a single pass.
+ * Glushkov positions of all patterns are laid out one after another in one
+ * long bit vector (each pattern followed by an unused guard bit, so that no
+ * carry leaks into the next pattern) and simulated together with the
+ * Shift-And step used for single patterns.
+ */
+class PatternSet
+{
+public:
+  explicit PatternSet(std::vector<std::string_view> const & patterns);
+
+  std::size_t size() const;
+
+  // i-th element tells whether the string matches i-th pattern
+  std::vector<bool> matches(std::string_view string) const;
+
+  // i-th element holds results of matching i-th string
+  std::vector<std::vector<bool>> matches(std::vector<std::string_view> const & strings) const;
+
+private:
+  void match(std::string_view string, std::vector<std::uint64_t> & state, std::vector<bool> & result) const;
+
+  std::size_t words;
+  std::vector<std::uint64_t> masks; // [byte][word]
+  std::vector<std::uint64_t> repeatable;
+  std::vector<std::uint64_t> skippable;
+  std::vector<std::uint64_t> starts;
+  std::vector<std::uint64_t> accepting;
+  std::vector<std::size_t> first_positions; // of each pattern
+  std::vector<bool> nullable;
+};
+
+}
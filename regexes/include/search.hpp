@@ -0,0 +1,100 @@
+#pragma once
+#include "pattern_parser.hpp"
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace regexes
+{
+
+struct Match
+{
+  std::size_t position;
+  std::size_t length;
+};
+
+inline bool operator==(Match const & lhs, Match const & rhs)
+{
+  return lhs.position == rhs.position && lhs.length == rhs.length;
+}
+
+inline bool operator!=(Match const & lhs, Match const & rhs)
+{
+  return !(lhs == rhs);
+}
+
+/*
+ * Leftmost, and among those the longest, match of the pattern in the string.
+ * Found in a single pass over the string, in O(n * m) time.
+ */
+std::optional<Match> find (std::string_view string, Pattern const & pattern);
+
+struct Searcher;
+
+/*
+ * Non-overlapping matches of a pattern in a string, found lazily while
+ * iterating, each one with find semantics. After an empty match the search
+ * resumes one char later. The search state is allocated once per range.
+ * The range refers to the string, which has to outlive it.
+ */
+class MatchRange
+{
+public:
+  class iterator
+  {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Match;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Match const *;
+    using reference = Match const &;
+
+    reference operator*() const
+    {
+      return *current;
+    }
+    pointer operator->() const
+    {
+      return &*current;
+    }
+    iterator & operator++();
+    bool operator==(iterator const & other) const
+    {
+      return current == other.current;
+    }
+    bool operator!=(iterator const & other) const
+    {
+      return !(*this == other);
+    }
+
+  private:
+    friend class MatchRange;
+    iterator(MatchRange * range, std::optional<Match> current)
+    : range{range}
+    , current{current}
+    {}
+    MatchRange * range;
+    std::optional<Match> current;
+  };
+
+  MatchRange(std::string_view string, Pattern const & pattern);
+  ~MatchRange();
+  MatchRange(MatchRange &&) noexcept;
+  MatchRange & operator=(MatchRange &&) noexcept;
+
+  iterator begin();
+  iterator end();
+
+private:
+  std::optional<Match> next();
+
+  std::string_view string;
+  std::size_t from;
+  std::unique_ptr<Searcher> searcher;
+};
+
+MatchRange find_all (std::string_view string, Pattern const & pattern);
+
+}
@@ -0,0 +1,270 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+namespace regexes
+{
+namespace Details
+{
+
+/*
+ * Single char position, as in positions.hpp: tokens repeated {m,n} times
+ * expand to m mandatory positions and n - m skippable ones.
+ */
+struct StaticPosition
+{
+  constexpr bool accepts(char c) const
+  {
+    auto const byte = static_cast<unsigned char>(c);
+    return (accepted[byte / 64] >> (byte % 64)) & 1u;
+  }
+
+  constexpr void accept(unsigned char first, unsigned char last)
+  {
+    for (unsigned byte = first; byte <= last; ++byte)
+      accepted[byte / 64] |= std::uint64_t{1} << (byte % 64);
+  }
+
+  std::uint64_t accepted[4]{};
+  bool skippable = false;
+  bool repeatable = false;
+};
+
+constexpr bool is_digit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+constexpr std::size_t unbounded_repetition = std::numeric_limits<std::size_t>::max();
+
+// largest m and n of a repetition, as max_repetition of the runtime parser
+constexpr std::size_t max_repetition = 1000;
+
+// parses a decimal count at j, false if it exceeds max_repetition
+constexpr bool parse_count(char const * pattern, std::size_t end, std::size_t & j, std::size_t & count)
+{
+  count = 0;
+  for (; j < end && is_digit(pattern[j]); ++j)
+  {
+    count = 10 * count + static_cast<std::size_t>(pattern[j] - '0');
+    if (count > max_repetition)
+      return false;
+  }
+  return true;
+}
+
+// parses {m}, {m,} or {m,n} at i, moving i past it if it's valid
+constexpr bool parse_repetition(char const * pattern, std::size_t end, std::size_t & i, std::size_t & min,
+                                std::size_t & max)
+{
+  auto j = i + 1;
+  if (j >= end || !is_digit(pattern[j]))
+    return false;
+  std::size_t first = 0;
+  if (!parse_count(pattern, end, j, first))
+    return false;
+  auto second = first;
+  if (j < end && pattern[j] == ',')
+  {
+    ++j;
+    if (j < end && is_digit(pattern[j]))
+    {
+      if (!parse_count(pattern, end, j, second))
+        return false;
+    }
+    else
+      second = unbounded_repetition;
+  }
+  if (j >= end || pattern[j] != '}' || second < first)
+    return false;
+  min = first;
+  max = second;
+  i = j + 1;
+  return true;
+}
+
+template <char... Chars>
+struct CharPack
+{
+  static constexpr char value[] = {Chars..., '\0'};
+};
+
+} // namespace Details
+
+/*
+ * Pattern parsed at compile time, with the same syntax as tokenize accepts.
+ * N is the size of the pattern literal, which bounds the number of char
+ * positions; a {m,n} repetition expanding the pattern beyond it throws
+ * std::length_error and a reversed range like [z-a] std::invalid_argument,
+ * either failing to compile in a constant expression. Both parsing and
+ * matching are constexpr, so matches can be checked in static_asserts and
+ * fully inlined when the string is known at runtime only. Anchors match the
+ * whole string anyway.
+ */
+template <std::size_t N>
+class StaticPattern
+{
+public:
+  constexpr explicit StaticPattern(char const (&pattern)[N])
+  {
+    std::size_t i = 0;
+    auto const end = pattern[N - 1] == '\0' ? N - 1 : N;
+    while (i < end)
+    {
+      if ((i == 0 && pattern[i] == '^') || (i + 1 == end && pattern[i] == '$'))
+      {
+        ++i;
+        continue;
+      }
+      Details::StaticPosition token;
+      switch (pattern[i])
+      {
+      case '.':
+        token.accept(0, 255);
+        ++i;
+        break;
+      case '[':
+        i = parse_charset(pattern, end, i + 1, token);
+        break;
+      default:
+        token.accept(static_cast<unsigned char>(pattern[i]), static_cast<unsigned char>(pattern[i]));
+        ++i;
+        break;
+      }
+      std::size_t min = 1;
+      std::size_t max = 1;
+      if (i < end && (pattern[i] == '*' || pattern[i] == '+' || pattern[i] == '?'))
+      {
+        min = pattern[i] == '+' ? 1 : 0;
+        max = pattern[i] == '?' ? 1 : Details::unbounded_repetition;
+        ++i;
+      }
+      else if (i < end && pattern[i] == '{')
+        Details::parse_repetition(pattern, end, i, min, max);
+      add(token, min, max);
+    }
+  }
+
+  // number of char positions
+  constexpr std::size_t size() const
+  {
+    return count;
+  }
+
+  /*
+   * Simulation of the set of positions which may consume the next char
+   * (position count standing for the end of the pattern).
+   */
+  constexpr bool matches(std::string_view string) const
+  {
+    std::array<bool, N + 1> active{};
+    active[0] = true;
+    close(active);
+    for (auto c : string)
+    {
+      std::array<bool, N + 1> next{};
+      bool any = false;
+      for (std::size_t p = 0; p < count; ++p)
+      {
+        if (active[p] && positions[p].accepts(c))
+        {
+          next[p + 1] = true;
+          next[p] = next[p] || positions[p].repeatable;
+          any = true;
+        }
+      }
+      if (!any)
+        return false;
+      close(next);
+      active = next;
+    }
+    return active[count];
+  }
+
+private:
+  static constexpr std::size_t parse_charset(char const (&pattern)[N], std::size_t end, std::size_t i,
+                                             Details::StaticPosition & token)
+  {
+    bool const negated = i < end && pattern[i] == '^';
+    if (negated)
+      ++i;
+    for (; i < end && pattern[i] != ']'; ++i)
+    {
+      auto const first = static_cast<unsigned char>(pattern[i]);
+      auto last = first;
+      if (i + 2 < end && pattern[i + 1] == '-' && pattern[i + 2] != ']')
+      {
+        i += 2;
+        last = static_cast<unsigned char>(pattern[i]);
+        if (last < first)
+          throw std::invalid_argument{"reversed range in a character group"};
+      }
+      token.accept(first, last);
+    }
+    if (negated)
+      for (auto & word : token.accepted)
+        word = ~word;
+    return i < end ? i + 1 : i;
+  }
+
+  // appends positions of a token matched from min to max times
+  constexpr void add(Details::StaticPosition token, std::size_t min, std::size_t max)
+  {
+    bool const repeatable = max == Details::unbounded_repetition;
+    auto const needed = repeatable ? std::max<std::size_t>(min, 1) : max;
+    if (needed > N - count)
+      throw std::length_error{"repetition expands the pattern beyond its literal size"};
+    for (std::size_t k = 0; k < min; ++k)
+    {
+      positions[count] = token;
+      positions[count++].repeatable = repeatable && k + 1 == min;
+    }
+    if (repeatable && min == 0)
+    {
+      positions[count] = token;
+      positions[count].skippable = true;
+      positions[count++].repeatable = true;
+    }
+    for (auto k = min; !repeatable && k < max; ++k)
+    {
+      positions[count] = token;
+      positions[count++].skippable = true;
+    }
+  }
+
+  // skippable positions may be passed without consuming input
+  constexpr void close(std::array<bool, N + 1> & active) const
+  {
+    for (std::size_t p = 0; p < count; ++p)
+      if (active[p] && positions[p].skippable)
+        active[p + 1] = true;
+  }
+
+  std::array<Details::StaticPosition, N> positions{};
+  std::size_t count = 0;
+};
+
+template <std::size_t N>
+constexpr StaticPattern<N> make_static_pattern(char const (&pattern)[N])
+{
+  return StaticPattern<N>{pattern};
+}
+
+/*
+ * Pattern given as a pack of chars, e.g. static_pattern<'a', '*', '.'>
+ */
+template <char... Chars>
+inline constexpr StaticPattern<sizeof...(Chars) + 1> static_pattern{Details::CharPack<Chars...>::value};
+
+template <std::size_t N>
+constexpr bool matches (std::string_view string, StaticPattern<N> const & pattern)
+{
+  return pattern.matches(string);
+}
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "pattern_parser.hpp"
+#include <memory>
+#include <string_view>
+
+namespace regexes
+{
+
+/*
+ * Anchored matching of input arriving in consecutive chunks. Only the state
+ * of the automaton is kept between chunks, so memory use depends on the
+ * pattern alone and the chunks don't have to be concatenated.
+ */
+class StreamMatcher
+{
+public:
+  explicit StreamMatcher(Pattern const & pattern);
+  ~StreamMatcher();
+  StreamMatcher(StreamMatcher &&) noexcept;
+  StreamMatcher & operator=(StreamMatcher &&) noexcept;
+
+  // consumes the next chunk of the input
+  void feed(std::string_view chunk);
+
+  // whether the input fed so far matches the pattern
+  bool finish() const;
+
+  // forgets the input fed so far
+  void reset();
+
+  struct Engine;
+
+private:
+  std::unique_ptr<Engine> engine;
+};
+
+}
@@ -0,0 +1,103 @@
+#include "batch.hpp"
+#include "nfa_simulation.hpp"
+#include "positions.hpp"
+#include "prefilter.hpp"
+#include "shift_and.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace regexes
+{
+
+namespace
+{
+
+// 8 words of results, one cache line
+constexpr std::size_t chunk_size = 512;
+
+/*
+ * Splits inputs into chunks taken by the workers from a shared counter, so
+ * that slow chunks do not hold up the others. make_matcher is called once per
+ * worker, to set up its scratch state.
+ */
+template <typename MakeMatcher>
+void run_workers (Prefilter const & prefilter, MakeMatcher const & make_matcher, std::string_view const * inputs,
+                  std::size_t count, std::uint64_t * bitmap, unsigned threads)
+{
+  std::size_t const chunks = (count + chunk_size - 1) / chunk_size;
+  std::atomic<std::size_t> next_chunk{0};
+  auto const work = [&] {
+    auto matcher = make_matcher();
+    for (std::size_t chunk; (chunk = next_chunk.fetch_add(1, std::memory_order_relaxed)) < chunks;)
+    {
+      auto const end = std::min(count, (chunk + 1) * chunk_size);
+      for (auto begin = chunk * chunk_size; begin < end; begin += 64)
+      {
+        std::uint64_t bits = 0;
+        for (auto i = begin; i < std::min(end, begin + 64); ++i)
+          bits |= std::uint64_t{prefilter.may_match(inputs[i]) && matcher(inputs[i])} << (i - begin);
+        bitmap[begin / 64] = bits;
+      }
+    }
+  };
+
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  auto const workers = static_cast<std::size_t>(std::min<std::size_t>(threads, chunks));
+  std::vector<std::thread> helpers;
+  try
+  {
+    for (std::size_t i = 1; i < workers; ++i)
+      helpers.emplace_back(work);
+  }
+  catch (...)
+  { // fewer threads than asked for, the ones running take the remaining chunks
+  }
+  work();
+  for (auto & helper : helpers)
+    helper.join();
+}
+
+template <std::size_t Bits>
+void shift_and_batch (Pattern const & pattern, Prefilter const & prefilter, std::string_view const * inputs,
+                      std::size_t count, std::uint64_t * bitmap, unsigned threads)
+{
+  ShiftAnd<Bits> const engine{pattern};
+  auto const make_matcher = [&engine] {
+    return [&engine](std::string_view string) { return engine.matches(string); };
+  };
+  run_workers(prefilter, make_matcher, inputs, count, bitmap, threads);
+}
+
+} // namespace
+
+void matches_batch (Pattern const & pattern, std::string_view const * inputs, std::size_t count,
+                    std::uint64_t * bitmap, unsigned threads)
+{
+  Prefilter const prefilter{pattern};
+  auto const positions = count_positions(pattern, 257);
+  if (positions <= 64)
+    return shift_and_batch<64>(pattern, prefilter, inputs, count, bitmap, threads);
+  if (positions <= 128)
+    return shift_and_batch<128>(pattern, prefilter, inputs, count, bitmap, threads);
+  if (positions <= 256)
+    return shift_and_batch<256>(pattern, prefilter, inputs, count, bitmap, threads);
+
+  NfaProgram const program{pattern};
+  auto const make_matcher = [&program] {
+    return [simulation = NfaSimulation{program}](std::string_view string) mutable {
+      return simulation.matches(string);
+    };
+  };
+  run_workers(prefilter, make_matcher, inputs, count, bitmap, threads);
+}
+
+Bitmap matches_batch (Pattern const & pattern, std::vector<std::string_view> const & inputs, unsigned threads)
+{
+  Bitmap bitmap((inputs.size() + 63) / 64);
+  matches_batch(pattern, inputs.data(), inputs.size(), bitmap.data(), threads);
+  return bitmap;
+}
+
+}
@@ -0,0 +1,115 @@
+#include "compiled_pattern.hpp"
+#include "positions.hpp"
+
+#include <map>
+
+namespace regexes
+{
+
+namespace
+{
+
+constexpr std::size_t alphabet_size = 256;
+constexpr std::uint32_t dead_state = 0;
+constexpr std::uint32_t start_state = 1;
+
+using StateSet = std::vector<std::uint32_t>;
+
+/*
+ * Glushkov automaton of a pattern. State i means that the next char has to
+ * be consumed by position i or later, or by position i - 1 if it is
+ * repeatable and consumed the previous char. State 0 is the initial one.
+ */
+struct Nfa
+{
+  explicit Nfa(Pattern const & pattern)
+  {
+    for_each_position(pattern, [this](Position const & position) { positions.push_back(position); });
+    nullable_from.assign(positions.size() + 1, true);
+    for (auto i = positions.size(); i > 0; --i)
+      nullable_from[i - 1] = nullable_from[i] && positions[i - 1].skippable;
+  }
+
+  // positions which may consume the next char, when in any of given states
+  StateSet follow(StateSet const & states) const
+  {
+    std::vector<bool> candidates(positions.size(), false);
+    for (auto state : states)
+    {
+      if (state > 0 && positions[state - 1].repeatable)
+        candidates[state - 1] = true;
+      for (auto p = state; p < positions.size(); ++p)
+      {
+        candidates[p] = true;
+        if (!positions[p].skippable)
+          break;
+      }
+    }
+    StateSet result;
+    for (std::uint32_t p = 0; p < candidates.size(); ++p)
+      if (candidates[p])
+        result.push_back(p);
+    return result;
+  }
+
+  bool accepting(StateSet const & states) const
+  {
+    for (auto state : states)
+      if (nullable_from[state])
+        return true;
+    return false;
+  }
+
+  std::vector<Position> positions;
+  std::vector<bool> nullable_from;
+};
+
+} // namespace
+
+CompiledPattern::CompiledPattern(Pattern const & pattern)
+{
+  Nfa const nfa{pattern};
+  std::vector<StateSet> subsets{{}, {0}};
+  std::map<StateSet, State> ids{{subsets[dead_state], dead_state}, {subsets[start_state], start_state}};
+  for (std::size_t state = 0; state < subsets.size(); ++state)
+  {
+    auto const candidates = nfa.follow(subsets[state]);
+    accepting.push_back(nfa.accepting(subsets[state]));
+    transitions.resize(transitions.size() + alphabet_size, dead_state);
+    for (std::size_t c = 0; c < alphabet_size; ++c)
+    {
+      StateSet next;
+      for (auto p : candidates)
+        if (nfa.positions[p].accepted[c])
+          next.push_back(p + 1);
+      auto [it, inserted] = ids.emplace(std::move(next), static_cast<State>(subsets.size()));
+      if (inserted)
+        subsets.push_back(it->first);
+      transitions[state * alphabet_size + c] = it->second;
+    }
+  }
+}
+
+bool CompiledPattern::matches(std::string_view string) const
+{
+  State state = start_state;
+  for (auto c : string)
+  {
+    state = transitions[state * alphabet_size + static_cast<unsigned char>(c)];
+    if (state == dead_state)
+      return false;
+  }
+  return accepting[state];
+}
+
+std::size_t CompiledPattern::states() const
+{
+  return accepting.size();
+}
+
+bool matches (std::string_view string, CompiledPattern const & pattern)
+{
+  return pattern.matches(string);
+}
+
+}
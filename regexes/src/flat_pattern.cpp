@@ -0,0 +1,141 @@
+#include "flat_pattern.hpp"
+#include "to_intermediate.hpp"
+
+namespace regexes
+{
+
+namespace
+{
+
+FlatToken::Policy to_policy(std::size_t threshold)
+{
+  switch (threshold)
+  {
+  case 0:
+    return FlatToken::Policy::Always;
+  case 1:
+    return FlatToken::Policy::AfterMatch;
+  case unbounded:
+    return FlatToken::Policy::Never;
+  default:
+    return FlatToken::Policy::AfterMatches;
+  }
+}
+
+FlatToken to_flat(TokenType type, Repetition repetition,
+                  std::string_view::const_iterator pattern_begin,
+                  std::string_view::const_iterator pattern_end)
+{
+  switch (type)
+  {
+  case TokenType::Char:
+    return FlatToken::character(*pattern_begin, repetition.min, repetition.max);
+  case TokenType::Wildcard:
+    return FlatToken::wildcard(repetition.min, repetition.max);
+  case TokenType::Charset:
+    return FlatToken::charset(charset_bytes(pattern_begin, pattern_end), repetition.min, repetition.max);
+  case TokenType::Anchor:
+    break;
+  }
+  return FlatToken::charset(ByteSet{}, repetition.min, repetition.max);
+}
+
+} // namespace
+
+FlatToken::FlatToken(Kind kind, std::size_t min_matches, std::size_t max_matches)
+: kind{kind}
+, matched_cryterium{to_policy(min_matches)}
+, exhausted_cryterium{to_policy(max_matches)}
+, matched_count{min_matches}
+, exhausted_count{max_matches}
+, bitmap{}
+{}
+
+FlatToken FlatToken::character(char value, std::size_t min_matches, std::size_t max_matches)
+{
+  FlatToken result{Kind::Char, min_matches, max_matches};
+  result.value = value;
+  return result;
+}
+
+FlatToken FlatToken::charset(ByteSet const & accepted_chars, std::size_t min_matches, std::size_t max_matches)
+{
+  FlatToken result{Kind::Charset, min_matches, max_matches};
+  for (std::size_t byte = 0; byte < accepted_chars.size(); ++byte)
+    if (accepted_chars[byte])
+      result.bitmap[byte / 64] |= std::uint64_t{1} << (byte % 64);
+  return result;
+}
+
+FlatToken FlatToken::wildcard(std::size_t min_matches, std::size_t max_matches)
+{
+  return {Kind::Wildcard, min_matches, max_matches};
+}
+
+ByteSet FlatToken::accepted() const
+{
+  switch (kind)
+  {
+  case Kind::Char:
+    return ByteSet{}.set(static_cast<unsigned char>(value));
+  case Kind::Charset:
+    break;
+  case Kind::Wildcard:
+    return ByteSet{}.set();
+  }
+  ByteSet result;
+  for (auto word = std::size(bitmap); word > 0; --word)
+    result = (result << 64) | ByteSet{bitmap[word - 1]};
+  return result;
+}
+
+std::size_t FlatToken::min_matches() const
+{
+  return matched_count;
+}
+
+std::size_t FlatToken::max_matches() const
+{
+  return exhausted_count;
+}
+
+FlatPattern tokenize_flat (std::string_view pattern)
+{
+  FlatPattern result;
+  auto pattern_it = pattern.cbegin();
+  while (pattern_it != pattern.cend())
+  {
+    auto [type, mod, length, repetition] = get_next_token(pattern_it, pattern.cend(), pattern_it == pattern.cbegin());
+    result.push_back(to_flat(type, repetition, pattern_it, pattern.cend()));
+    std::advance(pattern_it, length);
+  }
+  return result;
+}
+
+FlatToken flatten (Token const & token)
+{
+  auto const min = token.min_matches();
+  auto const max = token.max_matches();
+  auto const accepted_chars = token.accepted();
+  if (accepted_chars.all())
+    return FlatToken::wildcard(min, max);
+  if (accepted_chars.count() == 1)
+  {
+    std::size_t byte = 0;
+    while (!accepted_chars[byte])
+      ++byte;
+    return FlatToken::character(static_cast<char>(byte), min, max);
+  }
+  return FlatToken::charset(accepted_chars, min, max);
+}
+
+FlatPattern flatten (Pattern const & pattern)
+{
+  FlatPattern result;
+  result.reserve(pattern.size());
+  for (auto const & token : pattern)
+    result.push_back(flatten(token));
+  return result;
+}
+
+}
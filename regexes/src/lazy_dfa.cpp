@@ -0,0 +1,204 @@
+#include "lazy_dfa.hpp"
+#include "nfa_simulation.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace regexes
+{
+
+namespace
+{
+
+using State = std::uint32_t;
+using StateSet = std::vector<std::uint32_t>; // sorted NfaProgram states
+using ByteClasses = std::array<std::uint8_t, 256>;
+
+struct StateSetHash
+{
+  std::size_t operator()(StateSet const & set) const
+  {
+    std::size_t result = set.size();
+    for (auto state : set)
+      result = (result ^ state) * 0x100000001b3u;
+    return result;
+  }
+};
+
+constexpr std::size_t alphabet_size = 256;
+constexpr State dead_state = 0;
+constexpr State start_state = 1;
+constexpr State unknown = std::numeric_limits<State>::max();
+// dead, start, current and next one
+constexpr std::size_t min_states = 4;
+// transitions taken per cached state, below which a flush means a fallback
+constexpr std::size_t flush_progress = 10;
+
+/*
+ * Partitions bytes into classes of those accepted by the same tokens, so that
+ * transitions are kept once per class. Returns the number of classes.
+ */
+std::size_t byte_classes(NfaProgram const & program, ByteClasses & class_of)
+{
+  class_of.fill(0);
+  std::size_t classes = 1;
+  for (auto const & token : program.tokens)
+  {
+    // splits each class into bytes accepted by the token and the others
+    std::vector<int> split(2 * classes, -1);
+    classes = 0;
+    for (std::size_t byte = 0; byte < alphabet_size; ++byte)
+    {
+      auto & id = split[2 * class_of[byte] + (token.accepted[byte] ? 1 : 0)];
+      if (id < 0)
+        id = static_cast<int>(classes++);
+      class_of[byte] = static_cast<std::uint8_t>(id);
+    }
+  }
+  return classes;
+}
+
+} // namespace
+
+struct LazyDfa::Cache
+{
+  Cache(Pattern const & pattern, std::size_t max_states)
+  : program{pattern}
+  , simulation{program}
+  , closure{program.states()}
+  , classes{byte_classes(program, class_of)}
+  , max_states{std::max(max_states, min_states)}
+  {
+    program.add_closure(0, 0, [this](std::size_t state) { return closure.insert(state); });
+    start_set.assign(closure.begin(), closure.end());
+    std::sort(start_set.begin(), start_set.end());
+    clear();
+  }
+
+  void clear()
+  {
+    transitions.clear();
+    accepting.clear();
+    sets.clear();
+    ids.clear();
+    add({});
+    add(start_set);
+    taken_at_flush = stats.hits + stats.misses;
+  }
+
+  // flushes the cache, returns whether it filled up too fast to be of use
+  bool flush()
+  {
+    ++stats.flushes;
+    auto const slow = stats.hits + stats.misses - taken_at_flush < flush_progress * max_states;
+    clear();
+    return slow;
+  }
+
+  State add(StateSet set)
+  {
+    auto const [it, inserted] = ids.emplace(std::move(set), static_cast<State>(sets.size()));
+    if (inserted)
+    {
+      sets.push_back(&it->first);
+      accepting.push_back(std::binary_search(it->first.begin(), it->first.end(), program.final_state()));
+      transitions.resize(transitions.size() + classes, unknown);
+    }
+    return it->second;
+  }
+
+  // computes and caches the transition, unknown if that needs a new state
+  // and the cache is full
+  State build(State state, unsigned char byte)
+  {
+    ++stats.misses;
+    closure.clear();
+    for (auto nfa_state : *sets[state])
+    {
+      auto const token = program.token_of[nfa_state];
+      auto const & info = program.tokens[token];
+      auto const times_matched = nfa_state - info.offset;
+      if (times_matched < info.max && info.accepted[byte])
+        program.add_closure(token, std::min(times_matched + 1, info.cap),
+                            [this](std::size_t next) { return closure.insert(next); });
+    }
+    StateSet next(closure.begin(), closure.end());
+    std::sort(next.begin(), next.end());
+    if (sets.size() >= max_states && ids.find(next) == ids.end())
+      return unknown;
+    auto const result = add(std::move(next));
+    transitions[state * classes + class_of[byte]] = result;
+    return result;
+  }
+
+  NfaProgram const program;
+  NfaSimulation simulation;
+  SparseSet closure;
+  ByteClasses class_of;
+  std::size_t const classes;
+  std::size_t const max_states;
+  StateSet start_set;
+  std::vector<State> transitions; // [state][byte class]
+  std::vector<bool> accepting;
+  std::vector<StateSet const *> sets; // keys of ids
+  std::unordered_map<StateSet, State, StateSetHash> ids;
+  std::size_t taken_at_flush = 0;
+  Stats stats{};
+};
+
+LazyDfa::LazyDfa(Pattern const & pattern, std::size_t max_states)
+: cache{std::make_unique<Cache>(pattern, max_states)}
+{}
+
+LazyDfa::~LazyDfa() = default;
+LazyDfa::LazyDfa(LazyDfa &&) noexcept = default;
+LazyDfa & LazyDfa::operator=(LazyDfa &&) noexcept = default;
+
+bool LazyDfa::matches(std::string_view string)
+{
+  auto & c = *cache;
+  State state = start_state;
+  for (auto ch : string)
+  {
+    auto const byte = static_cast<unsigned char>(ch);
+    auto next = c.transitions[state * c.classes + c.class_of[byte]];
+    if (next != unknown)
+      ++c.stats.hits;
+    else if ((next = c.build(state, byte)) == unknown)
+    {
+      auto current = *c.sets[state];
+      if (c.flush())
+      {
+        ++c.stats.fallbacks;
+        return c.simulation.matches(string);
+      }
+      state = c.add(std::move(current));
+      next = c.build(state, byte);
+    }
+    if (next == dead_state)
+      return false;
+    state = next;
+  }
+  return c.accepting[state];
+}
+
+LazyDfa::Stats LazyDfa::stats() const
+{
+  return cache->stats;
+}
+
+std::size_t LazyDfa::states() const
+{
+  return cache->sets.size();
+}
+
+bool matches (std::string_view string, LazyDfa & pattern)
+{
+  return pattern.matches(string);
+}
+
+}
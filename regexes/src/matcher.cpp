@@ -1,56 +1,95 @@
 #include "matcher.hpp"
+#include "flat_pattern.hpp"
+#include "nfa_simulation.hpp"
+#include "pattern_cache.hpp"
 #include "pattern_parser.hpp"
-#include <queue>
+#include "prefilter.hpp"
+#include "shift_and.hpp"
+#include <type_traits>
+#include <variant>
 
 namespace regexes
 {
 
 bool matches (std::string_view string, std::string_view pattern)
 {
-  return matches(string, tokenize(pattern));
+  return default_pattern_cache().matcher(pattern)->matches(string);
 }
 
-struct MatchEnd
+namespace
 {
-  std::string_view::const_iterator string_pos;
-  Pattern::const_iterator pattern_pos;
-  std::size_t times_matched;
-};
+
+using Automaton = std::variant<ShiftAnd<64>, ShiftAnd<128>, ShiftAnd<256>, NfaProgram>;
+
+// the bit-parallel engine when the whole state fits in a few words
+template <typename PatternT>
+Automaton select_automaton (PatternT const & pattern)
+{
+  auto const positions = count_positions(pattern, 257);
+  if (positions <= 64)
+    return Automaton{std::in_place_type<ShiftAnd<64>>, pattern};
+  if (positions <= 128)
+    return Automaton{std::in_place_type<ShiftAnd<128>>, pattern};
+  if (positions <= 256)
+    return Automaton{std::in_place_type<ShiftAnd<256>>, pattern};
+  return Automaton{std::in_place_type<NfaProgram>, pattern};
+}
+
+bool run (Automaton const & automaton, std::string_view string)
+{
+  return std::visit(
+    [string](auto const & engine) {
+      if constexpr (std::is_same_v<std::decay_t<decltype(engine)>, NfaProgram>)
+        return NfaSimulation{engine}.matches(string);
+      else
+        return engine.matches(string);
+    },
+    automaton);
+}
+
+// rejects strings with wrong prefix before setting up an engine
+template <typename PatternT>
+bool select_and_match (std::string_view string, PatternT const & pattern)
+{
+  if (!Prefilter{pattern}.may_match(string))
+    return false;
+  return run(select_automaton(pattern), string);
+}
+
+} // namespace
 
 bool matches (std::string_view string, Pattern const & pattern)
 {
-  std::queue<MatchEnd> match_branches;
-  match_branches.push({string.cbegin(), pattern.cbegin(), 0u});
-  while (!match_branches.empty())
-  {
-    MatchEnd branch = match_branches.front();
-    auto [string_pos, pattern_pos, times_matched] = branch;
-    match_branches.pop();
-    if (string_pos == string.cend() && pattern_pos == pattern.cend())
-    {
-      return true;
-    }
-    if (pattern_pos == pattern.cend())
-    { // kill branch if reached pattern end without reaching string end
-      continue;
-    }
-    if (pattern_pos->matched(times_matched))
-    {
-      // if given pattern was matched sufficently many times, can branch
-      // to matching next pattern at current position
-      match_branches.push({string_pos, std::next(pattern_pos), 0u});
-    }
-    if (pattern_pos->exhausted(times_matched))
-    { // if pattern was matched, then already in queue with next pattern
-      continue;
-    }
-    if (string_pos != string.cend() && pattern_pos->accepts(*string_pos))
-    {
-      // pattern matches and was not exhausted, increase match count and go to next char
-      match_branches.push({std::next(string_pos), pattern_pos, times_matched + 1});
-    }
-  }
-  return false;
+  return select_and_match(string, pattern);
+}
+
+bool matches (std::string_view string, FlatPattern const & pattern)
+{
+  // same engines as for Token, lowered without virtual calls
+  return select_and_match(string, pattern);
+}
+
+struct Matcher::Engine
+{
+  Prefilter prefilter;
+  Automaton automaton;
+};
+
+Matcher::Matcher(Pattern const & pattern)
+: engine{new Engine{Prefilter{pattern}, select_automaton(pattern)}}
+{}
+
+Matcher::Matcher(FlatPattern const & pattern)
+: engine{new Engine{Prefilter{pattern}, select_automaton(pattern)}}
+{}
+
+Matcher::Matcher(Matcher &&) noexcept = default;
+Matcher & Matcher::operator=(Matcher &&) noexcept = default;
+Matcher::~Matcher() = default;
+
+bool Matcher::matches(std::string_view string) const
+{
+  return engine->prefilter.may_match(string) && run(engine->automaton, string);
 }
 
 }
@@ -0,0 +1,112 @@
+#include "nfa_simulation.hpp"
+
+namespace regexes
+{
+
+NfaSimulation::NfaSimulation(NfaProgram const & program)
+: program{program}
+, current{program.tokens.size()}
+, next{program.tokens.size()}
+, entered(program.states())
+, head(program.tokens.size())
+, size(program.tokens.size())
+{}
+
+void NfaSimulation::start()
+{
+  steps = 0;
+  next.clear();
+  enter(0);
+  std::swap(current, next);
+}
+
+bool NfaSimulation::step(char c)
+{
+  auto const byte = static_cast<unsigned char>(c);
+  ++steps;
+  next.clear();
+  for (auto token : current)
+  {
+    auto const & info = program.tokens[token];
+    if (!info.accepted[byte])
+      continue;
+    // counts grow by one each step, so at most one state gets exhausted (it
+    // couldn't consume c) or saturated (alike to an older one) at a time
+    if (info.max != unbounded)
+    {
+      if (times_matched(token, 0) > info.max)
+        pop_front(token);
+    }
+    else if (size[token] > 1 && times_matched(token, 1) >= info.min)
+      pop_front(token);
+    if (size[token] > 0)
+      next.insert(token);
+  }
+  auto const survivors = next.size();
+  for (auto it = next.begin(); it != next.begin() + static_cast<std::ptrdiff_t>(survivors); ++it)
+  {
+    auto const min = program.tokens[*it].min;
+    if (*it + 1 < program.tokens.size() && (min == 0 || times_matched(*it, 0) >= min))
+      enter(*it + 1);
+  }
+  std::swap(current, next);
+  return !current.empty();
+}
+
+bool NfaSimulation::accepting() const
+{
+  return current.contains(program.tokens.size() - 1);
+}
+
+bool NfaSimulation::matches(std::string_view string)
+{
+  start();
+  for (auto c : string)
+    if (!step(c))
+      return false;
+  return accepting();
+}
+
+void NfaSimulation::enter(std::size_t token)
+{
+  auto const last = program.tokens.size() - 1;
+  while (true)
+  {
+    auto const & info = program.tokens[token];
+    if (next.contains(token))
+    {
+      // entered in this step already, or alike to a state matched before
+      if ((info.max == unbounded && info.min == 0) || times_matched(token, size[token] - 1) == 0)
+        return;
+    }
+    else
+    {
+      next.insert(token);
+      size[token] = 0;
+    }
+    entered[slot(token, size[token]++)] = steps;
+    if (token == last || info.min > 0)
+      return;
+    ++token;
+  }
+}
+
+std::size_t NfaSimulation::slot(std::size_t token, std::size_t index) const
+{
+  auto const & info = program.tokens[token];
+  auto const wrapped = head[token] + index;
+  return info.offset + (wrapped > info.cap ? wrapped - info.cap - 1 : wrapped);
+}
+
+std::size_t NfaSimulation::times_matched(std::size_t token, std::size_t index) const
+{
+  return steps - entered[slot(token, index)];
+}
+
+void NfaSimulation::pop_front(std::size_t token)
+{
+  head[token] = head[token] == program.tokens[token].cap ? 0 : head[token] + 1;
+  --size[token];
+}
+
+}
@@ -0,0 +1,184 @@
+#pragma once
+#include "pattern_parser.hpp"
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+namespace regexes
+{
+
+/*
+ * States of the Thompson automaton of a pattern. A state is a pair of a token
+ * and the number of times it was matched, saturated at the count from which
+ * further matches don't change the outcome (min_matches() for unbounded
+ * tokens, max_matches() otherwise). The extra last token is the final state.
+ */
+class NfaProgram
+{
+public:
+  struct TokenStates
+  {
+    ByteSet accepted;
+    std::size_t min;
+    std::size_t max;
+    std::size_t cap;    // largest times_matched distinguished for the token
+    std::size_t offset; // of the state with times_matched == 0
+  };
+
+  template <typename PatternT>
+  explicit NfaProgram(PatternT const & pattern)
+  {
+    tokens.reserve(pattern.size() + 1);
+    std::size_t offset = 0;
+    for (auto const & token : pattern)
+    {
+      auto const min = token.min_matches();
+      auto const max = token.max_matches();
+      auto const cap = max == unbounded ? min : max;
+      tokens.push_back({token.accepted(), min, max, cap, offset});
+      offset += cap + 1;
+    }
+    tokens.push_back({ByteSet{}, 0, 0, 0, offset});
+    token_of.reserve(offset + 1);
+    for (std::size_t t = 0; t < tokens.size(); ++t)
+      token_of.insert(token_of.end(), tokens[t].cap + 1, t);
+  }
+
+  std::size_t states() const
+  {
+    return token_of.size();
+  }
+
+  std::size_t final_state() const
+  {
+    return tokens.back().offset;
+  }
+
+  // calls insert with the state and those reachable from it without consuming
+  // input, until insert reports a state as already present
+  template <typename Insert>
+  void add_closure(std::size_t token, std::size_t times_matched, Insert && insert) const
+  {
+    auto const last = tokens.size() - 1;
+    while (insert(tokens[token].offset + times_matched) && token != last && times_matched >= tokens[token].min)
+    {
+      // token matched sufficiently many times, next one can be tried right away
+      ++token;
+      times_matched = 0;
+    }
+  }
+
+  std::vector<TokenStates> tokens;
+  std::vector<std::size_t> token_of; // token of each state
+};
+
+/*
+ * Set of states with O(1) insertion, lookup and clearing, and iteration in
+ * insertion order. Never allocates after construction.
+ */
+class SparseSet
+{
+public:
+  explicit SparseSet(std::size_t capacity)
+  : dense(capacity)
+  , sparse(capacity)
+  {}
+
+  // returns whether the value was not in the set before
+  bool insert(std::size_t value)
+  {
+    if (contains(value))
+      return false;
+    sparse[value] = count;
+    dense[count++] = value;
+    return true;
+  }
+
+  bool contains(std::size_t value) const
+  {
+    return sparse[value] < count && dense[sparse[value]] == value;
+  }
+
+  void clear()
+  {
+    count = 0;
+  }
+
+  // keeps only the first size values inserted
+  void truncate(std::size_t size)
+  {
+    count = std::min(count, size);
+  }
+
+  bool empty() const
+  {
+    return count == 0;
+  }
+
+  std::size_t size() const
+  {
+    return count;
+  }
+
+  std::vector<std::size_t>::const_iterator begin() const
+  {
+    return dense.cbegin();
+  }
+
+  std::vector<std::size_t>::const_iterator end() const
+  {
+    return dense.cbegin() + static_cast<std::ptrdiff_t>(count);
+  }
+
+private:
+  std::vector<std::size_t> dense;
+  std::vector<std::size_t> sparse;
+  std::size_t count = 0;
+};
+
+/*
+ * Simulation of an NfaProgram keeping, for each active token, the counting
+ * set of its active states: the steps at which they were entered, oldest
+ * (most matched) first. Consuming a char advances all counts of a token at
+ * once, so a step costs O(1) per active token whatever the repetition bounds,
+ * O(n * t) time in total for t tokens, and O(m) memory for m states with no
+ * allocation once constructed.
+ */
+class NfaSimulation
+{
+public:
+  // keeps a reference to program, which must outlive the simulation
+  explicit NfaSimulation(NfaProgram const & program);
+  NfaSimulation(NfaProgram &&) = delete;
+
+  // activates the initial state, dropping all others
+  void start();
+
+  // consumes c, returns whether any state is still active
+  bool step(char c);
+
+  bool accepting() const;
+
+  bool matches(std::string_view string);
+
+private:
+  // enters token (and those reachable from it without consuming input) with
+  // times_matched == 0
+  void enter(std::size_t token);
+
+  // index in entered of the state index-th oldest among those of the token
+  std::size_t slot(std::size_t token, std::size_t index) const;
+  std::size_t times_matched(std::size_t token, std::size_t index) const;
+  void pop_front(std::size_t token);
+
+  NfaProgram const & program;
+  SparseSet current; // tokens with active states
+  SparseSet next;
+  // ring buffers of entry steps, the one of each token has a slot per state
+  std::vector<std::size_t> entered;
+  std::vector<std::size_t> head;
+  std::vector<std::size_t> size;
+  std::size_t steps = 0;
+};
+
+}
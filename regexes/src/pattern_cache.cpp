@@ -0,0 +1,114 @@
+#include "pattern_cache.hpp"
+#include <utility>
+
+namespace regexes
+{
+
+PatternCache::PatternCache(std::size_t capacity)
+: capacity_{capacity}
+{}
+
+PatternCache::Compiled::Compiled(Pattern && tokens)
+: pattern{std::move(tokens)}
+, matcher{pattern}
+{}
+
+std::shared_ptr<Pattern const> PatternCache::get(std::string_view text)
+{
+  auto compiled = find_or_compile(text);
+  auto const pattern = &compiled->pattern;
+  return {std::move(compiled), pattern};
+}
+
+std::shared_ptr<Matcher const> PatternCache::matcher(std::string_view text)
+{
+  auto compiled = find_or_compile(text);
+  auto const matcher = &compiled->matcher;
+  return {std::move(compiled), matcher};
+}
+
+std::shared_ptr<PatternCache::Compiled const> PatternCache::find_or_compile(std::string_view text)
+{
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (auto found = lookup(text))
+    {
+      ++stats_.hits;
+      return found;
+    }
+    ++stats_.misses;
+  }
+  // tokenize and set up the matcher without blocking other threads
+  auto compiled = std::make_shared<Compiled const>(tokenize(text));
+  std::lock_guard<std::mutex> lock{mutex};
+  if (auto found = lookup(text))
+  { // inserted by another thread in the meantime
+    return found;
+  }
+  if (capacity_ > 0)
+  {
+    entries.push_front({std::string{text}, compiled});
+    index.emplace(entries.front().text, entries.begin());
+    evict_over_capacity();
+  }
+  return compiled;
+}
+
+PatternCache::Stats PatternCache::stats() const
+{
+  std::lock_guard<std::mutex> lock{mutex};
+  return stats_;
+}
+
+std::size_t PatternCache::size() const
+{
+  std::lock_guard<std::mutex> lock{mutex};
+  return entries.size();
+}
+
+std::size_t PatternCache::capacity() const
+{
+  std::lock_guard<std::mutex> lock{mutex};
+  return capacity_;
+}
+
+void PatternCache::set_capacity(std::size_t capacity)
+{
+  std::lock_guard<std::mutex> lock{mutex};
+  capacity_ = capacity;
+  evict_over_capacity();
+}
+
+void PatternCache::clear()
+{
+  std::lock_guard<std::mutex> lock{mutex};
+  index.clear();
+  entries.clear();
+}
+
+std::shared_ptr<PatternCache::Compiled const> PatternCache::lookup(std::string_view text)
+{
+  auto const found = index.find(text);
+  if (found == index.end())
+    return nullptr;
+  entries.splice(entries.begin(), entries, found->second);
+  return found->second->compiled;
+}
+
+void PatternCache::evict_over_capacity()
+{
+  while (entries.size() > capacity_)
+  {
+    index.erase(entries.back().text);
+    entries.pop_back();
+    ++stats_.evictions;
+  }
+}
+
+PatternCache & default_pattern_cache()
+{
+  static PatternCache cache{1024};
+  return cache;
+}
+
+}
@@ -1,7 +1,7 @@
 #include "pattern_parser.hpp"
 #include "to_intermediate.hpp"
 
-#include <set>
+#include <new>
 
 namespace regexes
 {
@@ -10,18 +10,58 @@ struct Matcher
 {
   virtual ~Matcher() = default;
   virtual bool accepts(char c) const = 0;
+  virtual ByteSet accepted() const = 0;
+  virtual Anchor anchor() const { return Anchor::None; }
 };
 
 struct SatisfiedPolicy
 {
   virtual ~SatisfiedPolicy() = default;
   virtual bool satisfied(std::size_t times_matched) const = 0;
+  // smallest times_matched for which the policy is satisfied
+  virtual std::size_t threshold() const = 0;
 };
 
+/*
+ * Deleter of objects allocated from a memory resource, leaving alone the
+ * shared ones, which have no resource.
+ */
+struct ResourceDelete
+{
+  std::pmr::memory_resource * resource;
+  std::size_t size;
+  std::size_t alignment;
+
+  template <typename T>
+  void operator()(T const * object) const
+  {
+    if (resource == nullptr)
+      return;
+    object->~T();
+    resource->deallocate(const_cast<T *>(object), size, alignment);
+  }
+};
+
+template <typename T>
+using ResourcePtr = std::unique_ptr<T const, ResourceDelete>;
+
+template <typename T, typename... Args>
+ResourcePtr<T> make_in (std::pmr::memory_resource * resource, Args&&... args)
+{
+  auto const object = new (resource->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  return {object, {resource, sizeof(T), alignof(T)}};
+}
+
+template <typename T>
+ResourcePtr<T> shared (T const & object)
+{
+  return {&object, {nullptr, 0, 0}};
+}
+
 struct Token::Impl {
-  Impl(std::unique_ptr<Matcher>&& matcher,
-       std::unique_ptr<SatisfiedPolicy>&& matched_cryterium,
-       std::unique_ptr<SatisfiedPolicy>&& exhausted_cryterium)
+  Impl(ResourcePtr<Matcher>&& matcher,
+       ResourcePtr<SatisfiedPolicy>&& matched_cryterium,
+       ResourcePtr<SatisfiedPolicy>&& exhausted_cryterium)
   : matcher{std::move(matcher)}
   , matched_cryterium{std::move(matched_cryterium)}
   , exhausted_cryterium{std::move(exhausted_cryterium)}
@@ -38,23 +78,40 @@ struct Token::Impl {
   {
     return exhausted_cryterium->satisfied(times_matched);
   }
+  ByteSet accepted() const
+  {
+    return matcher->accepted();
+  }
+  std::size_t min_matches() const
+  {
+    return matched_cryterium->threshold();
+  }
+  std::size_t max_matches() const
+  {
+    return exhausted_cryterium->threshold();
+  }
+  Anchor anchor() const
+  {
+    return matcher->anchor();
+  }
 private:
-  std::unique_ptr<Matcher> matcher;
-  std::unique_ptr<SatisfiedPolicy> matched_cryterium;
-  std::unique_ptr<SatisfiedPolicy> exhausted_cryterium;
+  ResourcePtr<Matcher> matcher;
+  ResourcePtr<SatisfiedPolicy> matched_cryterium;
+  ResourcePtr<SatisfiedPolicy> exhausted_cryterium;
 };
 
+void Token::ImplDelete::operator()(Impl * impl) const
+{
+  impl->~Impl();
+  resource->deallocate(impl, sizeof(Impl), alignof(Impl));
+}
+
 Token::~Token() = default;
 
-Token::Token(std::unique_ptr<Matcher>&& matcher,
-             std::unique_ptr<SatisfiedPolicy>&& matched_cryterium,
-             std::unique_ptr<SatisfiedPolicy>&& exhausted_cryterium)
-: pImpl{std::make_unique<Impl>(std::move(matcher),
-                               std::move(matched_cryterium),
-                               std::move(exhausted_cryterium))}
+Token::Token(std::unique_ptr<Impl, ImplDelete>&& impl)
+: pImpl{std::move(impl)}
 {}
 
-
 bool Token::accepts(char c) const
 {
   return pImpl->accepts(c);
@@ -70,19 +127,51 @@ bool Token::exhausted(std::size_t times_matched) const
   return pImpl->exhausted(times_matched);
 }
 
+ByteSet Token::accepted() const
+{
+  return pImpl->accepted();
+}
+
+std::size_t Token::min_matches() const
+{
+  return pImpl->min_matches();
+}
+
+std::size_t Token::max_matches() const
+{
+  return pImpl->max_matches();
+}
+
+Anchor Token::anchor() const
+{
+  return pImpl->anchor();
+}
+
 struct AlwaysSatisfied : SatisfiedPolicy
 {
-  bool satisfied(std::size_t) const { return true; }
+  bool satisfied(std::size_t) const override { return true; }
+  std::size_t threshold() const override { return 0; }
 };
 
 struct NeverSatisfied : SatisfiedPolicy
 {
-  bool satisfied(std::size_t) const { return false; }
+  bool satisfied(std::size_t) const override { return false; }
+  std::size_t threshold() const override { return unbounded; }
 };
 
 struct SatisfiedAfterMatch : SatisfiedPolicy
 {
-  bool satisfied(std::size_t times_matched) const { return times_matched > 0; }
+  bool satisfied(std::size_t times_matched) const override { return times_matched > 0; }
+  std::size_t threshold() const override { return 1; }
+};
+
+struct SatisfiedAfterMatches : SatisfiedPolicy
+{
+  SatisfiedAfterMatches(std::size_t count) : count(count) {}
+  bool satisfied(std::size_t times_matched) const override { return times_matched >= count; }
+  std::size_t threshold() const override { return count; }
+private:
+  std::size_t count;
 };
 
 struct CharMatcher : Matcher
@@ -90,83 +179,103 @@ struct CharMatcher : Matcher
 public:
   CharMatcher(char value) : value(value) {}
   bool accepts(char c) const override { return c == value; }
+  ByteSet accepted() const override { return ByteSet{}.set(static_cast<unsigned char>(value)); }
 private:
   char value;
 };
 
 struct Charset : Matcher
 {
-  Charset(std::set<char>&& accepted_chars)
-  : accepted_chars(std::make_move_iterator(accepted_chars.begin()),
-                   std::make_move_iterator(accepted_chars.end()))
-  {}
-  bool accepts(char c) const override
-  {
-    return c == *std::lower_bound(accepted_chars.cbegin(), accepted_chars.cend(), c);
-  }
+  Charset(ByteSet const & accepted_chars) : accepted_chars(accepted_chars) {}
+  bool accepts(char c) const override { return accepted_chars[static_cast<unsigned char>(c)]; }
+  ByteSet accepted() const override { return accepted_chars; }
 private:
-  std::vector<char> accepted_chars;
+  ByteSet accepted_chars;
 };
 
 struct Wildcard : Matcher
 {
   bool accepts(char) const override { return true; }
+  ByteSet accepted() const override { return ByteSet{}.set(); }
+};
+
+struct AnchorMatcher : Matcher
+{
+  AnchorMatcher(Anchor kind) : kind(kind) {}
+  bool accepts(char) const override { return false; }
+  ByteSet accepted() const override { return {}; }
+  Anchor anchor() const override { return kind; }
+private:
+  Anchor kind;
 };
 
-Token to_object (TokenType type, Modifier mod,
-                 std::string_view::const_iterator pattern_begin)
+// stateless matchers and policies are shared by all tokens
+AlwaysSatisfied const always_satisfied;
+NeverSatisfied const never_satisfied;
+SatisfiedAfterMatch const satisfied_after_match;
+Wildcard const wildcard;
+AnchorMatcher const start_anchor{Anchor::Start};
+AnchorMatcher const end_anchor{Anchor::End};
+
+ResourcePtr<SatisfiedPolicy> satisfied_after (std::size_t times_matched, std::pmr::memory_resource * resource)
+{
+  switch (times_matched)
+  {
+  case 0:
+    return shared<SatisfiedPolicy>(always_satisfied);
+  case 1:
+    return shared<SatisfiedPolicy>(satisfied_after_match);
+  case unbounded:
+    return shared<SatisfiedPolicy>(never_satisfied);
+  default:
+    return make_in<SatisfiedAfterMatches>(resource, times_matched);
+  }
+}
+
+ResourcePtr<Matcher> to_matcher (TokenType type,
+                                 std::string_view::const_iterator pattern_begin,
+                                 std::string_view::const_iterator pattern_end,
+                                 std::pmr::memory_resource * resource)
 {
-  std::unique_ptr<Matcher> matcher;
   switch (type)
   {
   case TokenType::Char:
-  {
-    matcher = std::make_unique<CharMatcher>(*pattern_begin);
-    break;
-  }
+    return make_in<CharMatcher>(resource, *pattern_begin);
   case TokenType::Wildcard:
-  {
-    matcher = std::make_unique<Wildcard>();
-    break;
-  }
+    return shared<Matcher>(wildcard);
   case TokenType::Charset:
-  {
-    std::set<char> accepted_chars;
-    for (auto it = ++pattern_begin; *it != ']'; ++it)
-      accepted_chars.emplace(*it);
-    matcher = std::make_unique<Charset>(std::move(accepted_chars));
-    break;
-  }
-  }
-  std::unique_ptr<SatisfiedPolicy> matched_cryterium;
-  std::unique_ptr<SatisfiedPolicy> exhausted_cryterium;
-  switch (mod)
-  {
-  case Modifier::None:
-  {
-    matched_cryterium = std::make_unique<SatisfiedAfterMatch>();
-    exhausted_cryterium = std::make_unique<SatisfiedAfterMatch>();
-    break;
-  }
-  case Modifier::Star:
-  {
-    matched_cryterium = std::make_unique<AlwaysSatisfied>();
-    exhausted_cryterium = std::make_unique<NeverSatisfied>();
+    return make_in<Charset>(resource, charset_bytes(pattern_begin, pattern_end));
+  case TokenType::Anchor:
     break;
   }
-  }
-  return {std::move(matcher), std::move(matched_cryterium), std::move(exhausted_cryterium)};
+  return shared<Matcher>(*pattern_begin == '^' ? start_anchor : end_anchor);
+}
+
+Token to_object (TokenType type, Repetition repetition,
+                 std::string_view::const_iterator pattern_begin,
+                 std::string_view::const_iterator pattern_end,
+                 std::pmr::memory_resource * resource)
+{
+  // quantifiers are counted by the policies, {1,1000} is still a single token
+  auto matcher = to_matcher(type, pattern_begin, pattern_end, resource);
+  auto matched_cryterium = satisfied_after(repetition.min, resource);
+  auto exhausted_cryterium = satisfied_after(repetition.max, resource);
+  auto const impl = new (resource->allocate(sizeof(Token::Impl), alignof(Token::Impl)))
+      Token::Impl{std::move(matcher), std::move(matched_cryterium), std::move(exhausted_cryterium)};
+  return {std::unique_ptr<Token::Impl, Token::ImplDelete>{impl, {resource}}};
 }
 
-Pattern tokenize (std::string_view pattern)
+Pattern tokenize (std::string_view pattern, std::pmr::memory_resource * resource)
 {
-  Pattern result;
+  Pattern result{resource};
+  // no token is shorter than a char, and with an arena nothing is reallocated
+  result.reserve(pattern.size());
   auto pattern_it = pattern.cbegin();
   while (pattern_it != pattern.cend())
   {
-    auto next_token = get_next_token(pattern_it, pattern.cend());
+    auto next_token = get_next_token(pattern_it, pattern.cend(), pattern_it == pattern.cbegin());
     result.emplace_back(to_object(std::get<0>(next_token),
-                        std::get<1>(next_token), pattern_it));
+                        std::get<3>(next_token), pattern_it, pattern.cend(), resource));
     std::advance(pattern_it, std::get<2>(next_token));
   }
   return result;
@@ -0,0 +1,114 @@
+#include "pattern_set.hpp"
+#include "pattern_parser.hpp"
+#include "shift_and.hpp"
+
+#include <algorithm>
+
+namespace regexes
+{
+
+namespace
+{
+
+constexpr std::size_t alphabet_size = 256;
+
+void set_bit(std::vector<std::uint64_t> & bits, std::size_t i)
+{
+  bits[i / 64] |= std::uint64_t{1} << (i % 64);
+}
+
+} // namespace
+
+PatternSet::PatternSet(std::vector<std::string_view> const & patterns)
+{
+  std::vector<Pattern> tokenized;
+  tokenized.reserve(patterns.size());
+  std::size_t bits = 0;
+  for (auto pattern : patterns)
+  {
+    tokenized.push_back(tokenize(pattern));
+    first_positions.push_back(bits);
+    bits += count_positions(tokenized.back()) + 1;
+  }
+  words = std::max<std::size_t>(1, (bits + 63) / 64);
+  masks.assign(alphabet_size * words, 0);
+  repeatable.assign(words, 0);
+  skippable.assign(words, 0);
+  starts.assign(words, 0);
+  accepting.assign(words, 0);
+
+  for (std::size_t i = 0; i < tokenized.size(); ++i)
+  {
+    auto position = first_positions[i];
+    std::vector<std::size_t> mandatory;
+    for_each_position(tokenized[i], [&](Position const & p) {
+      for_each_byte(p.accepted, [&](unsigned char c) { set_bit(masks, c * words * 64 + position); });
+      if (p.repeatable)
+        set_bit(repeatable, position);
+      if (p.skippable)
+        set_bit(skippable, position);
+      else
+        mandatory.push_back(position);
+      ++position;
+    });
+    set_bit(starts, first_positions[i]);
+    // accepting are positions after which only skippable ones remain
+    auto const last_mandatory = mandatory.empty() ? first_positions[i] : mandatory.back();
+    for (auto p = last_mandatory; p < position; ++p)
+      set_bit(accepting, p);
+    nullable.push_back(mandatory.empty());
+  }
+}
+
+std::size_t PatternSet::size() const
+{
+  return first_positions.size();
+}
+
+std::vector<bool> PatternSet::matches(std::string_view string) const
+{
+  std::vector<std::uint64_t> state(words);
+  std::vector<bool> result;
+  match(string, state, result);
+  return result;
+}
+
+std::vector<std::vector<bool>> PatternSet::matches(std::vector<std::string_view> const & strings) const
+{
+  std::vector<std::uint64_t> state(words);
+  std::vector<std::vector<bool>> results(strings.size());
+  for (std::size_t i = 0; i < strings.size(); ++i)
+    match(strings[i], state, results[i]);
+  return results;
+}
+
+void PatternSet::match(std::string_view string, std::vector<std::uint64_t> & state, std::vector<bool> & result) const
+{
+  if (string.empty())
+  {
+    result = nullable;
+    return;
+  }
+  result.assign(size(), false);
+  std::fill(state.begin(), state.end(), 0);
+  auto const step = [&](char c, std::uint64_t const * first) {
+    auto const mask = masks.data() + static_cast<unsigned char>(c) * words;
+    return shift_and_step(state.data(), mask, repeatable.data(), skippable.data(), first, words);
+  };
+  auto any = step(string.front(), starts.data());
+  for (auto it = std::next(string.cbegin()); it != string.cend() && any; ++it)
+    any = step(*it, nullptr);
+  for (std::size_t w = 0; w < words; ++w)
+  {
+    auto accepted = state[w] & accepting[w];
+    while (accepted != 0)
+    {
+      auto const position = 64 * w + static_cast<std::size_t>(__builtin_ctzll(accepted));
+      auto const owner = std::upper_bound(first_positions.cbegin(), first_positions.cend(), position);
+      result[static_cast<std::size_t>(std::distance(first_positions.cbegin(), owner)) - 1] = true;
+      accepted &= accepted - 1;
+    }
+  }
+}
+
+}
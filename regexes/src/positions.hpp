@@ -0,0 +1,82 @@
+#pragma once
+#include "pattern_parser.hpp"
+
+namespace regexes
+{
+
+/*
+ * Single character position of the Glushkov automaton of a pattern.
+ * Each token expands to min_matches() mandatory positions, followed either by
+ * max_matches() - min_matches() optional ones or, for unbounded tokens, by
+ * making the last position repeatable (or adding one skippable, repeatable
+ * position if the token may not match at all).
+ */
+struct Position
+{
+  ByteSet accepted;
+  bool skippable;  // can be passed without consuming input
+  bool repeatable; // can consume input again right after consuming it
+};
+
+template <typename PatternT, typename Callback>
+void for_each_position(PatternT const & pattern, Callback && callback)
+{
+  for (auto const & token : pattern)
+  {
+    auto const accepted = token.accepted();
+    auto const min = token.min_matches();
+    auto const max = token.max_matches();
+    for (std::size_t i = 0; i < min; ++i)
+      callback(Position{accepted, false, max == unbounded && i + 1 == min});
+    if (max == unbounded)
+    {
+      if (min == 0)
+        callback(Position{accepted, true, true});
+    }
+    else
+    {
+      for (std::size_t i = min; i < max; ++i)
+        callback(Position{accepted, true, false});
+    }
+  }
+}
+
+/*
+ * Calls callback with the value of each byte in the set, in increasing order.
+ */
+template <typename Callback>
+void for_each_byte(ByteSet const & bytes, Callback && callback)
+{
+  ByteSet const low_word{~0ull};
+  auto rest = bytes;
+  for (std::size_t word = 0; rest.any(); ++word, rest >>= 64)
+  {
+    auto bits = (rest & low_word).to_ullong();
+    while (bits != 0)
+    {
+      callback(static_cast<unsigned char>(64 * word + static_cast<std::size_t>(__builtin_ctzll(bits))));
+      bits &= bits - 1;
+    }
+  }
+}
+
+/*
+ * Number of positions for_each_position would produce, saturating at limit.
+ */
+template <typename PatternT>
+std::size_t count_positions(PatternT const & pattern, std::size_t limit = unbounded)
+{
+  std::size_t result = 0;
+  for (auto const & token : pattern)
+  {
+    auto const min = token.min_matches();
+    auto const max = token.max_matches();
+    auto const count = max == unbounded ? (min == 0 ? 1 : min) : max;
+    if (count >= limit - result)
+      return limit;
+    result += count;
+  }
+  return result;
+}
+
+}
@@ -0,0 +1,130 @@
+#include "prefilter.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define REGEXES_X86_SIMD 1
+#endif
+
+namespace regexes
+{
+
+namespace
+{
+
+// up to this many distinct first bytes are scanned for with vector compares
+constexpr std::size_t max_needles = 4;
+
+using Needles = char const (&)[max_needles];
+
+std::size_t find_any_scalar(char const * data, std::size_t size, Needles needles)
+{
+  for (std::size_t i = 0; i < size; ++i)
+    if (data[i] == needles[0] || data[i] == needles[1] || data[i] == needles[2] || data[i] == needles[3])
+      return i;
+  return size;
+}
+
+#ifdef REGEXES_X86_SIMD
+
+__attribute__((target("sse2"))) std::size_t find_any_sse2(char const * data, std::size_t size, Needles needles)
+{
+  auto const n0 = _mm_set1_epi8(needles[0]);
+  auto const n1 = _mm_set1_epi8(needles[1]);
+  auto const n2 = _mm_set1_epi8(needles[2]);
+  auto const n3 = _mm_set1_epi8(needles[3]);
+  std::size_t i = 0;
+  for (; i + 16 <= size; i += 16)
+  {
+    auto const chunk = _mm_loadu_si128(static_cast<__m128i const *>(static_cast<void const *>(data + i)));
+    auto const found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, n0), _mm_cmpeq_epi8(chunk, n1)),
+                                    _mm_or_si128(_mm_cmpeq_epi8(chunk, n2), _mm_cmpeq_epi8(chunk, n3)));
+    auto const mask = static_cast<unsigned>(_mm_movemask_epi8(found));
+    if (mask != 0)
+      return i + static_cast<std::size_t>(__builtin_ctz(mask));
+  }
+  return i + find_any_scalar(data + i, size - i, needles);
+}
+
+__attribute__((target("avx2"))) std::size_t find_any_avx2(char const * data, std::size_t size, Needles needles)
+{
+  auto const n0 = _mm256_set1_epi8(needles[0]);
+  auto const n1 = _mm256_set1_epi8(needles[1]);
+  auto const n2 = _mm256_set1_epi8(needles[2]);
+  auto const n3 = _mm256_set1_epi8(needles[3]);
+  std::size_t i = 0;
+  for (; i + 32 <= size; i += 32)
+  {
+    auto const chunk = _mm256_loadu_si256(static_cast<__m256i const *>(static_cast<void const *>(data + i)));
+    auto const found = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, n0), _mm256_cmpeq_epi8(chunk, n1)),
+                                       _mm256_or_si256(_mm256_cmpeq_epi8(chunk, n2), _mm256_cmpeq_epi8(chunk, n3)));
+    auto const mask = static_cast<unsigned>(_mm256_movemask_epi8(found));
+    if (mask != 0)
+      return i + static_cast<std::size_t>(__builtin_ctz(mask));
+  }
+  return i + find_any_sse2(data + i, size - i, needles);
+}
+
+#endif
+
+using FindAny = std::size_t (*)(char const *, std::size_t, Needles);
+
+FindAny select_find_any()
+{
+#ifdef REGEXES_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return find_any_avx2;
+  if (__builtin_cpu_supports("sse2"))
+    return find_any_sse2;
+#endif
+  return find_any_scalar;
+}
+
+FindAny const find_any = select_find_any();
+
+} // namespace
+
+void Prefilter::init_scan()
+{
+  if (first_bytes.count() > max_needles)
+    return;
+  for_each_byte(first_bytes, [this](unsigned char c) { needles.push_back(static_cast<char>(c)); });
+}
+
+std::size_t Prefilter::scan(std::string_view string) const
+{
+  if (first_bytes.all())
+    return 0;
+  if (needles.size() == 1)
+  {
+    auto const found = std::memchr(string.data(), needles.front(), string.size());
+    return found == nullptr ? string.size() : static_cast<std::size_t>(static_cast<char const *>(found) - string.data());
+  }
+  if (!needles.empty())
+  {
+    char padded[max_needles];
+    for (std::size_t i = 0; i < max_needles; ++i)
+      padded[i] = needles[i < needles.size() ? i : 0];
+    return find_any(string.data(), string.size(), padded);
+  }
+  for (std::size_t i = 0; i < string.size(); ++i)
+    if (first_bytes[static_cast<unsigned char>(string[i])])
+      return i;
+  return string.size();
+}
+
+std::size_t Prefilter::next_candidate(std::string_view string, std::size_t from) const
+{
+  while (from < string.size())
+  {
+    from += scan(string.substr(from));
+    if (from == string.size() || string.compare(from, prefix.size(), prefix) == 0)
+      return from;
+    ++from;
+  }
+  return string.size();
+}
+
+}
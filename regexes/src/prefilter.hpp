@@ -0,0 +1,88 @@
+#pragma once
+#include "positions.hpp"
+#include <string>
+#include <string_view>
+
+namespace regexes
+{
+
+/*
+ * Conditions every non-empty match of a pattern has to satisfy, cheap enough
+ * to check before running a matching engine: the literal the match has to
+ * start with, and the set of bytes its first char belongs to.
+ * Scanning for the first byte uses SSE2/AVX2 compares when the set is small,
+ * picked at runtime according to the CPU features.
+ */
+class Prefilter
+{
+public:
+  template <typename PatternT>
+  explicit Prefilter(PatternT const & pattern)
+  {
+    nullable_ = true;
+    bool literal = true;
+    for (auto const & token : pattern)
+    {
+      if (!nullable_ && !literal)
+        break;
+      if (token.max_matches() == 0)
+        continue; // anchors consume nothing
+      auto const accepted = token.accepted();
+      auto const min = token.min_matches();
+      if (nullable_)
+        first_bytes |= accepted;
+      if (literal && min > 0 && accepted.count() == 1)
+      {
+        for_each_byte(accepted, [&](unsigned char c) { prefix.append(min, static_cast<char>(c)); });
+        literal = min == token.max_matches();
+      }
+      else
+        literal = false;
+      nullable_ = nullable_ && min == 0;
+    }
+    init_scan();
+  }
+
+  // false only if the string can't match the pattern
+  bool may_match(std::string_view string) const
+  {
+    if (string.empty())
+      return nullable_;
+    return first_bytes[static_cast<unsigned char>(string.front())] &&
+           string.substr(0, prefix.size()) == prefix;
+  }
+
+  // smallest position not less than from at which a non-empty match may
+  // start, string.size() if there is none
+  std::size_t next_candidate(std::string_view string, std::size_t from) const;
+
+  // whether the pattern matches the empty string
+  bool nullable() const
+  {
+    return nullable_;
+  }
+
+  std::string const & literal_prefix() const
+  {
+    return prefix;
+  }
+
+  ByteSet const & first_byte_set() const
+  {
+    return first_bytes;
+  }
+
+private:
+  void init_scan();
+
+  // position of the first byte from first_bytes in the string
+  std::size_t scan(std::string_view string) const;
+
+  std::string prefix;
+  ByteSet first_bytes;
+  bool nullable_;
+  // first_bytes listed, when there are at most needles.size() of them
+  std::string needles;
+};
+
+}
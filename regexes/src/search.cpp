@@ -0,0 +1,156 @@
+#include "search.hpp"
+#include "nfa_simulation.hpp"
+#include "prefilter.hpp"
+
+namespace regexes
+{
+
+/*
+ * Unanchored NFA simulation, in which each active state remembers where the
+ * match leading to it started. States are kept in order of their start
+ * positions and only the first (leftmost) start is kept for each state.
+ * Patterns starting with ^ only start matches at the start of the string,
+ * those ending with $ only accept them at its end.
+ */
+struct Searcher
+{
+  explicit Searcher(Pattern const & pattern)
+  : program{pattern}
+  , prefilter{pattern}
+  , current{program.states()}
+  , next{program.states()}
+  , current_starts(program.states())
+  , next_starts(program.states())
+  , anchored_start{!pattern.empty() && pattern.front().anchor() == Anchor::Start}
+  , anchored_end{!pattern.empty() && pattern.back().anchor() == Anchor::End}
+  {}
+
+  std::optional<Match> find(std::string_view string, std::size_t pos)
+  {
+    std::optional<Match> best;
+    current.clear();
+    while (true)
+    {
+      if (anchored_start)
+      {
+        if (pos == 0)
+          add(current, current_starts, 0, 0, pos);
+      }
+      else if (!best)
+      {
+        if (current.empty() && !prefilter.nullable())
+          pos = prefilter.next_candidate(string, pos);
+        add(current, current_starts, 0, 0, pos);
+      }
+      if (current.contains(program.final_state()) && (!anchored_end || pos == string.size()))
+      {
+        auto const start = current_starts[program.final_state()];
+        if (!best || start <= best->position)
+          best = Match{start, pos - start};
+        drop_started_after(start);
+      }
+      if (pos == string.size() || current.empty())
+        return best;
+      step(string[pos++]);
+    }
+  }
+
+private:
+  void add(SparseSet & states, std::vector<std::size_t> & starts, std::size_t token, std::size_t times_matched,
+           std::size_t start) const
+  {
+    program.add_closure(token, times_matched, [&](std::size_t state) {
+      if (!states.insert(state))
+        return false;
+      starts[state] = start;
+      return true;
+    });
+  }
+
+  void step(char c)
+  {
+    auto const byte = static_cast<unsigned char>(c);
+    next.clear();
+    for (auto state : current)
+    {
+      auto const & info = program.tokens[program.token_of[state]];
+      auto const times_matched = state - info.offset;
+      if (times_matched < info.max && info.accepted[byte])
+        add(next, next_starts, program.token_of[state], std::min(times_matched + 1, info.cap), current_starts[state]);
+    }
+    std::swap(current, next);
+    std::swap(current_starts, next_starts);
+  }
+
+  // matches starting later than the one found can't be leftmost
+  void drop_started_after(std::size_t start)
+  {
+    std::size_t kept = 0;
+    for (auto state : current)
+    {
+      if (current_starts[state] > start)
+        break;
+      ++kept;
+    }
+    current.truncate(kept);
+  }
+
+  NfaProgram const program;
+  Prefilter const prefilter;
+  SparseSet current;
+  SparseSet next;
+  std::vector<std::size_t> current_starts;
+  std::vector<std::size_t> next_starts;
+  bool const anchored_start;
+  bool const anchored_end;
+};
+
+std::optional<Match> find (std::string_view string, Pattern const & pattern)
+{
+  return Searcher{pattern}.find(string, 0);
+}
+
+MatchRange::MatchRange(std::string_view string, Pattern const & pattern)
+: string{string}
+, from{0}
+, searcher{std::make_unique<Searcher>(pattern)}
+{}
+
+MatchRange::~MatchRange() = default;
+MatchRange::MatchRange(MatchRange &&) noexcept = default;
+MatchRange & MatchRange::operator=(MatchRange &&) noexcept = default;
+
+MatchRange::iterator MatchRange::begin()
+{
+  return {this, next()};
+}
+
+MatchRange::iterator MatchRange::end()
+{
+  return {this, std::nullopt};
+}
+
+MatchRange::iterator & MatchRange::iterator::operator++()
+{
+  current = range->next();
+  return *this;
+}
+
+std::optional<Match> MatchRange::next()
+{
+  if (from > string.size())
+    return std::nullopt;
+  auto const match = searcher->find(string, from);
+  if (!match)
+    from = string.size() + 1;
+  else
+    from = match->position + match->length + (match->length == 0 ? 1 : 0);
+  return match;
+}
+
+MatchRange find_all (std::string_view string, Pattern const & pattern)
+{
+  return {string, pattern};
+}
+
+}
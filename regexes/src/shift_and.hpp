@@ -0,0 +1,146 @@
+#pragma once
+#include "positions.hpp"
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace regexes
+{
+
+/*
+ * Single step of a Shift-And simulation of a state spanning given number of
+ * words, consuming a char accepted by positions in mask.
+ * Candidates for consuming the char are the repeatable active positions and
+ * positions following the active ones (or the starting ones, when given),
+ * extended over runs of skippable positions. The extension is done by adding
+ * the candidates in runs to the skippable mask: the carry ripples to the end
+ * of the run, flipping all bits on its way.
+ * Returns whether any position is still active.
+ */
+inline bool shift_and_step(std::uint64_t * state, std::uint64_t const * mask,
+                           std::uint64_t const * repeatable, std::uint64_t const * skippable,
+                           std::uint64_t const * starts, std::size_t words)
+{
+  std::uint64_t shift_carry = 0;
+  std::uint64_t add_carry = 0;
+  std::uint64_t any = 0;
+  for (std::size_t w = 0; w < words; ++w)
+  {
+    auto candidates = (state[w] << 1) | shift_carry;
+    if (starts != nullptr)
+      candidates |= starts[w];
+    shift_carry = state[w] >> 63;
+    auto const partial = skippable[w] + (candidates & skippable[w]);
+    auto const sum = partial + add_carry;
+    add_carry = (partial < skippable[w]) | (sum < partial);
+    auto const reachable = (state[w] & repeatable[w]) | candidates | (sum ^ skippable[w]);
+    state[w] = reachable & mask[w];
+    any |= state[w];
+  }
+  return any != 0;
+}
+
+/*
+ * Bit-parallel (Shift-And) simulation of the Glushkov automaton of a pattern
+ * with at most Bits positions. Bit i of the state is set iff the last char
+ * could have been consumed by position i, so a step is a few word operations
+ * and a lookup in a per byte table of masks of positions accepting the byte.
+ */
+template <std::size_t Bits>
+class ShiftAnd
+{
+  static_assert(Bits % 64 == 0, "state is kept in whole 64 bit words");
+  static constexpr std::size_t words = Bits / 64;
+
+public:
+  using State = std::array<std::uint64_t, words>;
+
+  template <typename PatternT>
+  static bool fits(PatternT const & pattern)
+  {
+    return count_positions(pattern, Bits + 1) <= Bits;
+  }
+
+  template <typename PatternT>
+  explicit ShiftAnd(PatternT const & pattern)
+  {
+    State wildcards{};
+    std::size_t positions = 0;
+    for_each_position(pattern, [&](Position const & position) {
+      auto const word = positions / 64;
+      auto const bit = std::uint64_t{1} << (positions % 64);
+      if (position.accepted.all())
+        wildcards[word] |= bit;
+      else
+        for_each_byte(position.accepted, [&](unsigned char c) { masks[c][word] |= bit; });
+      if (position.repeatable)
+        repeatable[word] |= bit;
+      if (position.skippable)
+        skippable[word] |= bit;
+      ++positions;
+    });
+    for (auto & mask : masks)
+      for (std::size_t w = 0; w < words; ++w)
+        mask[w] |= wildcards[w];
+    nullable = true;
+    for (auto p = positions; p > 0; --p)
+    {
+      if (nullable)
+        accepting_positions[(p - 1) / 64] |= std::uint64_t{1} << ((p - 1) % 64);
+      nullable = nullable && (skippable[(p - 1) / 64] >> ((p - 1) % 64) & 1u);
+    }
+  }
+
+  // state of matching input given in consecutive parts
+  struct Run
+  {
+    State state{};
+    bool started = false;
+    bool active = true;
+  };
+
+  void feed(Run & run, std::string_view chunk) const
+  {
+    auto it = chunk.cbegin();
+    if (!run.started && it != chunk.cend())
+    {
+      State const first{1u};
+      run.active = step(run.state, *it++, first.data());
+      run.started = true;
+    }
+    for (; it != chunk.cend() && run.active; ++it)
+      run.active = step(run.state, *it, nullptr);
+  }
+
+  bool accepting(Run const & run) const
+  {
+    if (!run.started)
+      return nullable;
+    std::uint64_t accepted = 0;
+    for (std::size_t w = 0; w < words; ++w)
+      accepted |= run.state[w] & accepting_positions[w];
+    return accepted != 0;
+  }
+
+  bool matches(std::string_view string) const
+  {
+    Run run;
+    feed(run, string);
+    return accepting(run);
+  }
+
+private:
+  bool step(State & state, char c, std::uint64_t const * starts) const
+  {
+    return shift_and_step(state.data(), masks[static_cast<unsigned char>(c)].data(), repeatable.data(),
+                          skippable.data(), starts, words);
+  }
+
+  std::array<State, 256> masks{};
+  State repeatable{};
+  State skippable{};
+  State accepting_positions{};
+  bool nullable;
+};
+
+}
@@ -0,0 +1,109 @@
+#include "stream_matcher.hpp"
+#include "nfa_simulation.hpp"
+#include "shift_and.hpp"
+
+namespace regexes
+{
+
+struct StreamMatcher::Engine
+{
+  virtual ~Engine() = default;
+  virtual void feed(std::string_view chunk) = 0;
+  virtual bool accepting() const = 0;
+  virtual void reset() = 0;
+};
+
+namespace
+{
+
+template <std::size_t Bits>
+struct ShiftAndEngine : StreamMatcher::Engine
+{
+  explicit ShiftAndEngine(Pattern const & pattern)
+  : shift_and{pattern}
+  {}
+  void feed(std::string_view chunk) override
+  {
+    shift_and.feed(run, chunk);
+  }
+  bool accepting() const override
+  {
+    return shift_and.accepting(run);
+  }
+  void reset() override
+  {
+    run = {};
+  }
+
+private:
+  ShiftAnd<Bits> const shift_and;
+  typename ShiftAnd<Bits>::Run run;
+};
+
+struct NfaEngine : StreamMatcher::Engine
+{
+  explicit NfaEngine(Pattern const & pattern)
+  : program{pattern}
+  , simulation{program}
+  {
+    reset();
+  }
+  void feed(std::string_view chunk) override
+  {
+    for (auto it = chunk.cbegin(); it != chunk.cend() && active; ++it)
+      active = simulation.step(*it);
+  }
+  bool accepting() const override
+  {
+    return simulation.accepting();
+  }
+  void reset() override
+  {
+    simulation.start();
+    active = true;
+  }
+
+private:
+  NfaProgram const program;
+  NfaSimulation simulation;
+  bool active;
+};
+
+std::unique_ptr<StreamMatcher::Engine> make_engine(Pattern const & pattern)
+{
+  auto const positions = count_positions(pattern, 257);
+  if (positions <= 64)
+    return std::make_unique<ShiftAndEngine<64>>(pattern);
+  if (positions <= 128)
+    return std::make_unique<ShiftAndEngine<128>>(pattern);
+  if (positions <= 256)
+    return std::make_unique<ShiftAndEngine<256>>(pattern);
+  return std::make_unique<NfaEngine>(pattern);
+}
+
+} // namespace
+
+StreamMatcher::StreamMatcher(Pattern const & pattern)
+: engine{make_engine(pattern)}
+{}
+
+StreamMatcher::~StreamMatcher() = default;
+StreamMatcher::StreamMatcher(StreamMatcher &&) noexcept = default;
+StreamMatcher & StreamMatcher::operator=(StreamMatcher &&) noexcept = default;
+
+void StreamMatcher::feed(std::string_view chunk)
+{
+  engine->feed(chunk);
+}
+
+bool StreamMatcher::finish() const
+{
+  return engine->accepting();
+}
+
+void StreamMatcher::reset()
+{
+  engine->reset();
+}
+
+}
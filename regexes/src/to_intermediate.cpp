@@ -1,17 +1,59 @@
 #include "to_intermediate.hpp"
 
 #include <algorithm>
+#include <optional>
+#include <stdexcept>
 
 namespace regexes
 {
 
-using TokenDescription = std::tuple<TokenType, Modifier, std::size_t>;
+namespace
+{
+
+// parses a decimal number, if there is one not above max_repetition
+std::optional<std::size_t> parse_count(std::string_view::const_iterator & it,
+                                       std::string_view::const_iterator end)
+{
+  if (it == end || *it < '0' || *it > '9')
+    return std::nullopt;
+  std::size_t result = 0;
+  for (; it != end && *it >= '0' && *it <= '9'; ++it)
+  {
+    result = 10 * result + static_cast<std::size_t>(*it - '0');
+    if (result > max_repetition)
+      return std::nullopt;
+  }
+  return result;
+}
+
+// parses {m}, {m,} or {m,n} starting at it, returns its length
+std::size_t parse_repetition(std::string_view::const_iterator it, std::string_view::const_iterator end,
+                             Repetition & repetition)
+{
+  auto const begin = it++;
+  auto const min = parse_count(it, end);
+  if (!min || it == end)
+    return 0;
+  auto max = min;
+  if (*it == ',')
+  {
+    ++it;
+    max = (it != end && *it == '}') ? unbounded : parse_count(it, end);
+  }
+  if (!max || it == end || *it != '}' || *max < *min)
+    return 0;
+  repetition = {*min, *max};
+  return static_cast<std::size_t>(std::distance(begin, it)) + 1;
+}
+
+} // namespace
+
 TokenDescription get_next_token(
     std::string_view::const_iterator token_begin,
-    std::string_view::const_iterator pattern_end)
+    std::string_view::const_iterator pattern_end,
+    bool pattern_start)
 {
   TokenType tt;
-  Modifier mod = Modifier::None;
   std::size_t length = 0;
   switch (*token_begin)
   {
@@ -25,7 +67,18 @@ TokenDescription get_next_token(
   {
     tt = TokenType::Charset;
     auto token_end = std::find(token_begin, pattern_end, ']');
-    length = static_cast<std::size_t>(std::distance(token_begin, token_end)) + 1;
+    length = static_cast<std::size_t>(std::distance(token_begin, token_end));
+    if (token_end != pattern_end)
+      ++length;
+    break;
+  }
+  case '^':
+  case '$':
+  {
+    if ((*token_begin == '^' && pattern_start) || (*token_begin == '$' && std::next(token_begin) == pattern_end))
+      return {TokenType::Anchor, Modifier::None, 1, {0, 0}};
+    tt = TokenType::Char;
+    ++length;
     break;
   }
   default:
@@ -37,13 +90,54 @@ TokenDescription get_next_token(
   }
 
   std::advance(token_begin, length);
-  if (token_begin != pattern_end && *token_begin == '*')
+  if (token_begin == pattern_end)
+    return {tt, Modifier::None, length, {1, 1}};
+  switch (*token_begin)
   {
-    ++length;
-    mod = Modifier::Star;
+  case '*':
+    return {tt, Modifier::Star, length + 1, {0, unbounded}};
+  case '+':
+    return {tt, Modifier::Plus, length + 1, {1, unbounded}};
+  case '?':
+    return {tt, Modifier::Optional, length + 1, {0, 1}};
+  case '{':
+  {
+    Repetition repetition{1, 1};
+    if (auto const modifier_length = parse_repetition(token_begin, pattern_end, repetition))
+      return {tt, Modifier::Repeat, length + modifier_length, repetition};
+    break;
   }
+  default:
+    break;
+  }
+  return {tt, Modifier::None, length, {1, 1}};
+}
 
-  return {tt, mod, length};
+ByteSet charset_bytes(
+    std::string_view::const_iterator charset_begin,
+    std::string_view::const_iterator pattern_end)
+{
+  ByteSet result;
+  auto it = std::next(charset_begin);
+  bool const negated = it != pattern_end && *it == '^';
+  if (negated)
+    ++it;
+  for (; it != pattern_end && *it != ']'; ++it)
+  {
+    auto const first = static_cast<unsigned char>(*it);
+    auto last = first;
+    auto const dash = std::next(it);
+    if (dash != pattern_end && *dash == '-' && std::next(dash) != pattern_end && *std::next(dash) != ']')
+    {
+      it = std::next(dash);
+      last = static_cast<unsigned char>(*it);
+      if (last < first)
+        throw std::invalid_argument{"reversed range in a character group"};
+    }
+    for (unsigned byte = first; byte <= last; ++byte)
+      result.set(byte);
+  }
+  return negated ? ~result : result;
 }
 
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include "pattern_parser.hpp"
 #include <string_view>
 #include <tuple>
 
@@ -9,19 +10,53 @@ enum class TokenType
 {
   Char = 0,
   Charset = 1,
-  Wildcard = 2
+  Wildcard = 2,
+  Anchor = 3
 };
 
 enum class Modifier
 {
   None = 0,
-  Star = 1
+  Star = 1,
+  Plus = 2,
+  Optional = 3,
+  Repeat = 4
 };
 
-using TokenDescription = std::tuple<TokenType, Modifier, std::size_t>;
+/*
+ * Bounds on the number of times a token is matched, max may be unbounded.
+ */
+struct Repetition
+{
+  std::size_t min;
+  std::size_t max;
+};
+
+inline bool operator==(Repetition const & lhs, Repetition const & rhs)
+{
+  return lhs.min == rhs.min && lhs.max == rhs.max;
+}
+
+using TokenDescription = std::tuple<TokenType, Modifier, std::size_t, Repetition>;
 
+/*
+ * ^ is an anchor only at the start of the pattern and $ only at its end,
+ * elsewhere they are plain chars, as are modifiers with nothing to modify
+ * and braces which don't form a {m}, {m,} or {m,n} repetition.
+ */
 TokenDescription get_next_token(
     std::string_view::const_iterator token_begin,
+    std::string_view::const_iterator pattern_end,
+    bool pattern_start = false
+);
+
+/*
+ * Bytes accepted by the charset token starting at charset_begin: listed
+ * chars and ranges like a-f, all the other bytes if the list starts with ^.
+ * Throws std::invalid_argument on a reversed range like z-a.
+ */
+ByteSet charset_bytes(
+    std::string_view::const_iterator charset_begin,
     std::string_view::const_iterator pattern_end
 );
 
@@ -0,0 +1,56 @@
+#include "batch.hpp"
+#include "matcher.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <string>
+
+namespace
+{
+using namespace regexes;
+
+bool bit(Bitmap const & bitmap, std::size_t i)
+{
+  return (bitmap[i / 64] >> (i % 64)) & 1;
+}
+
+// too many positions for the bit-parallel engine
+std::string long_pattern()
+{
+  std::string pattern;
+  for (int i = 0; i < 300; ++i)
+    pattern += "[abc]*";
+  return pattern;
+}
+
+std::vector<std::string> make_inputs(std::size_t count)
+{
+  std::vector<std::string> inputs;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    std::string input;
+    for (auto n = i; n > 0; n /= 3)
+      input += "abc"[n % 3];
+    inputs.push_back(input);
+  }
+  return inputs;
+}
+
+TEST_CASE("Batch matching agrees with matching one by one", "[matches_batch]")
+{
+  auto const text = GENERATE(as<std::string>{}, "a*b*c*", ".*ab.*", "c.*", "[ab]*c", "", long_pattern());
+  auto const count = GENERATE(std::size_t{0}, 1, 63, 64, 513, 5000);
+  auto const threads = GENERATE(1u, 3u, 0u);
+
+  auto const pattern = tokenize(text);
+  auto const strings = make_inputs(count);
+  std::vector<std::string_view> const inputs(strings.begin(), strings.end());
+  auto const bitmap = matches_batch(pattern, inputs, threads);
+  REQUIRE(bitmap.size() == (count + 63) / 64);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(bitmap.data()) % 64 == 0);
+  for (std::size_t i = 0; i < count; ++i)
+    REQUIRE(bit(bitmap, i) == matches(inputs[i], pattern));
+  if (count % 64 != 0)
+    REQUIRE(bitmap.back() >> (count % 64) == 0);
+}
+
+}
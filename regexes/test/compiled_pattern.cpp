@@ -0,0 +1,54 @@
+#include "compiled_pattern.hpp"
+#include "matcher.hpp"
+#include <catch2/catch.hpp>
+#include <string>
+
+namespace
+{
+using namespace regexes;
+
+bool compiled_matches(std::string_view string, std::string_view pattern)
+{
+  return matches(string, CompiledPattern{tokenize(pattern)});
+}
+
+TEST_CASE("Compiled pattern matching works", "[CompiledPattern]")
+{
+  REQUIRE(compiled_matches("", ""));
+  REQUIRE(compiled_matches("a", "a"));
+  REQUIRE(compiled_matches("ab", "a."));
+  REQUIRE(compiled_matches("ab", ".."));
+  REQUIRE(compiled_matches("", "a*"));
+  REQUIRE(compiled_matches("aaaaa", ".*"));
+  REQUIRE(compiled_matches("aaabbaaabaaaaaaa", "aa*aab*aaab.a*"));
+  REQUIRE(compiled_matches("ba", "[ab][ab]"));
+  REQUIRE(compiled_matches("b", "[ab][c]*"));
+
+  REQUIRE(!compiled_matches("", "a*a"));
+  REQUIRE(!compiled_matches("ab", "aba"));
+  REQUIRE(!compiled_matches("ab", "abaa"));
+  REQUIRE(!compiled_matches("aaa", "...."));
+  REQUIRE(!compiled_matches("a", "b"));
+  REQUIRE(!compiled_matches("a", "ab"));
+  REQUIRE(!compiled_matches("ab", "a"));
+}
+
+TEST_CASE("Compiled pattern agrees with matches", "[CompiledPattern]")
+{
+  auto const pattern = "a*[bc].*c";
+  CompiledPattern const compiled{tokenize(pattern)};
+  for (std::string input : {"", "c", "bc", "ac", "aabxc", "aaccc", "b", "aaab", "cxyzc", "ab.c"})
+    REQUIRE(compiled.matches(input) == matches(input, pattern));
+}
+
+TEST_CASE("Compiled pattern handles repeated stars", "[CompiledPattern]")
+{
+  CompiledPattern const compiled{tokenize("a*a*a*a*b")};
+  std::string input(10000, 'a');
+  REQUIRE(!compiled.matches(input));
+  input.push_back('b');
+  REQUIRE(compiled.matches(input));
+  REQUIRE(compiled.states() <= 4);
+}
+
+}
@@ -0,0 +1,61 @@
+#include "flat_pattern.hpp"
+#include "matcher.hpp"
+#include <catch2/catch.hpp>
+
+namespace
+{
+using namespace regexes;
+
+bool flat_matches(std::string_view string, std::string_view pattern)
+{
+  auto const result = matches(string, tokenize_flat(pattern));
+  REQUIRE(result == matches(string, flatten(tokenize(pattern))));
+  return result;
+}
+
+TEST_CASE("Flat pattern matching works", "[FlatPattern]")
+{
+  REQUIRE(flat_matches("", ""));
+  REQUIRE(flat_matches("a", "a"));
+  REQUIRE(flat_matches("ab", "a."));
+  REQUIRE(flat_matches("ab", ".."));
+  REQUIRE(flat_matches("", "a*"));
+  REQUIRE(flat_matches("aaaaa", ".*"));
+  REQUIRE(flat_matches("aaabbaaabaaaaaaa", "aa*aab*aaab.a*"));
+  REQUIRE(flat_matches("ba", "[ab][ab]"));
+  REQUIRE(flat_matches("b", "[ab][c]*"));
+
+  REQUIRE(!flat_matches("", "a*a"));
+  REQUIRE(!flat_matches("ab", "aba"));
+  REQUIRE(!flat_matches("ab", "abaa"));
+  REQUIRE(!flat_matches("aaa", "...."));
+  REQUIRE(!flat_matches("a", "b"));
+  REQUIRE(!flat_matches("a", "ab"));
+  REQUIRE(!flat_matches("ab", "a"));
+  REQUIRE(!flat_matches("c", "[ab]"));
+
+  REQUIRE(flat_matches("aab7", "^a+b?[0-9]$"));
+  REQUIRE(flat_matches("xyxy", "[x-y]{2,4}"));
+  REQUIRE(!flat_matches("xyxyx", "[x-y]{2,4}"));
+  REQUIRE(!flat_matches("a", "[^a]"));
+}
+
+TEST_CASE("Flat tokens keep token semantics", "[FlatPattern]")
+{
+  auto const pattern = tokenize("^a.*[xyz]b+c?d{3,5}$");
+  auto const flat = flatten(pattern);
+  REQUIRE(flat.size() == pattern.size());
+  for (std::size_t i = 0; i < pattern.size(); ++i)
+  {
+    REQUIRE(flat[i].accepted() == pattern[i].accepted());
+    REQUIRE(flat[i].min_matches() == pattern[i].min_matches());
+    REQUIRE(flat[i].max_matches() == pattern[i].max_matches());
+    for (std::size_t times_matched = 0; times_matched < 7; ++times_matched)
+    {
+      REQUIRE(flat[i].matched(times_matched) == pattern[i].matched(times_matched));
+      REQUIRE(flat[i].exhausted(times_matched) == pattern[i].exhausted(times_matched));
+    }
+  }
+}
+
+}
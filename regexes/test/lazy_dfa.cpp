@@ -0,0 +1,115 @@
+#include "lazy_dfa.hpp"
+#include "matcher.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <string>
+
+namespace
+{
+using namespace regexes;
+
+TEST_CASE("Lazy DFA matching works", "[LazyDfa]")
+{
+  auto const lazy_matches = [](std::string_view string, std::string_view pattern) {
+    LazyDfa dfa{tokenize(pattern)};
+    return dfa.matches(string);
+  };
+  REQUIRE(lazy_matches("", ""));
+  REQUIRE(lazy_matches("a", "a"));
+  REQUIRE(lazy_matches("ab", "a."));
+  REQUIRE(lazy_matches("", "a*"));
+  REQUIRE(lazy_matches("aaabbaaabaaaaaaa", "aa*aab*aaab.a*"));
+  REQUIRE(lazy_matches("b", "[ab][c]*"));
+  REQUIRE(lazy_matches("aaab", "^a{2,3}b?$"));
+  REQUIRE(lazy_matches("xyzzy", "[^a-c]+"));
+
+  REQUIRE(!lazy_matches("", "a*a"));
+  REQUIRE(!lazy_matches("ab", "abaa"));
+  REQUIRE(!lazy_matches("aaa", "...."));
+  REQUIRE(!lazy_matches("a", "ab"));
+  REQUIRE(!lazy_matches("aaaab", "a{2,3}b"));
+}
+
+TEST_CASE("Lazy DFA agrees with matches", "[LazyDfa]")
+{
+  auto const inputs = {"", "a", "b", "ab", "ba", "aab", "abab", "bbbb", "aaaaaaaab", "abbbbbbbbba", "ababababab"};
+  for (auto pattern : {"a*b", ".*a.{3}b", "[ab]{2,4}", "a?b+a?", "(a*)", ".*ab.*", "a{0,3}a{3}b?"})
+  {
+    LazyDfa dfa{tokenize(pattern)};
+    for (auto input : inputs)
+    {
+      CAPTURE(pattern, input);
+      REQUIRE(dfa.matches(input) == matches(input, pattern));
+    }
+  }
+}
+
+TEST_CASE("Lazy DFA reuses cached states", "[LazyDfa]")
+{
+  LazyDfa dfa{tokenize("a*[bc].*c")};
+  std::string const input = "aaaaaabxyzxyzc";
+  REQUIRE(dfa.matches(input));
+  auto const first = dfa.stats();
+  REQUIRE(first.misses > 0);
+  REQUIRE(first.hits + first.misses == input.size());
+  REQUIRE(dfa.matches(input));
+  auto const second = dfa.stats();
+  REQUIRE(second.misses == first.misses);
+  REQUIRE(second.hits == first.hits + input.size());
+  REQUIRE(second.flushes == 0);
+  REQUIRE(second.fallbacks == 0);
+}
+
+TEST_CASE("Lazy DFA flushes a full cache", "[LazyDfa]")
+{
+  // every window of 9 chars is a distinct state
+  auto const pattern = ".*a.{8}b";
+  std::string input;
+  std::uint32_t random = 1;
+  for (std::size_t i = 0; i < 4000; ++i)
+  {
+    random = random * 1103515245u + 12345u;
+    input += (random >> 16) % 3 == 0 ? 'a' : 'b';
+  }
+  for (auto tail : {"", "a00000000b"})
+  {
+    LazyDfa dfa{tokenize(pattern), 64};
+    REQUIRE(dfa.matches(input + tail) == matches(input + tail, pattern));
+    REQUIRE(dfa.states() <= 64);
+    REQUIRE(dfa.stats().flushes > 0);
+  }
+
+  SECTION("and falls back to NFA simulation when it fills up too fast")
+  {
+    LazyDfa dfa{tokenize(pattern), 4};
+    REQUIRE(dfa.matches(input + "a00000000b"));
+    REQUIRE(!dfa.matches(input));
+    REQUIRE(dfa.stats().fallbacks == 2);
+    REQUIRE(dfa.states() <= 4);
+  }
+}
+
+TEST_CASE("Lazy DFA doesn't blow up on bounded repetition", "[LazyDfa]")
+{
+  LazyDfa dfa{tokenize("a{0,50}a{50}")};
+  REQUIRE(!dfa.matches(std::string(49, 'a')));
+  REQUIRE(dfa.matches(std::string(50, 'a')));
+  REQUIRE(dfa.matches(std::string(100, 'a')));
+  REQUIRE(!dfa.matches(std::string(101, 'a')));
+  // a state per number of a read, not per set of ways to split them
+  REQUIRE(dfa.states() <= 103);
+  REQUIRE(dfa.stats().flushes == 0);
+}
+
+TEST_CASE("Lazy DFA keeps few states on repeated stars", "[LazyDfa]")
+{
+  LazyDfa dfa{tokenize("a*a*a*a*b")};
+  std::string input(10000, 'a');
+  REQUIRE(!dfa.matches(input));
+  input.push_back('b');
+  REQUIRE(dfa.matches(input));
+  REQUIRE(dfa.states() <= 5);
+  REQUIRE(dfa.stats().flushes == 0);
+}
+
+}
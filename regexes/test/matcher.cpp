@@ -1,5 +1,9 @@
 #include "matcher.hpp"
+#include "flat_pattern.hpp"
+#include "pattern_parser.hpp"
 #include <catch2/catch.hpp>
+#include <stdexcept>
+#include <string>
 
 namespace
 {
@@ -26,4 +30,53 @@ TEST_CASE("Pattern matching works", "[Matcher]")
   REQUIRE(!matches("ab", "a"));
 }
 
+TEST_CASE("Quantifiers, ranges and anchors work", "[Matcher]")
+{
+  REQUIRE(matches("aaab", "a+b"));
+  REQUIRE(!matches("b", "a+b"));
+  REQUIRE(matches("b", "a?b"));
+  REQUIRE(matches("ab", "a?b"));
+  REQUIRE(!matches("aab", "a?b"));
+  REQUIRE(matches("aaa", "a{3}"));
+  REQUIRE(!matches("aa", "a{3}"));
+  REQUIRE(matches("abab", "[ab]{2,4}"));
+  REQUIRE(!matches("ababa", "[ab]{2,4}"));
+  REQUIRE(matches(std::string(50, 'x'), "x{2,}"));
+  REQUIRE(!matches("x", "x{2,}"));
+  REQUIRE(matches(std::string(1000, 'a'), "a{1,1000}"));
+  REQUIRE(!matches(std::string(1001, 'a'), "a{1,1000}"));
+  REQUIRE(matches("a{,2}", "a{,2}"));
+
+  REQUIRE(matches("c7", "[a-f][0-9]"));
+  REQUIRE(!matches("g7", "[a-f][0-9]"));
+  REQUIRE(matches("x-", "[^abc][a-]"));
+  REQUIRE(!matches("b", "[^abc]"));
+  REQUIRE_THROWS_AS(matches("b", "[z-a]"), std::invalid_argument);
+
+  REQUIRE(matches("abc", "^abc$"));
+  REQUIRE(matches("", "^$"));
+  REQUIRE(!matches("xabc", "^abc$"));
+  REQUIRE(matches("a^b$c", "a^b$c"));
+}
+
+TEST_CASE("Matcher agrees with one-shot matching", "[Matcher]")
+{
+  // up to 64, 128 and 256 positions, then NFA simulation
+  for (auto const text : {"a*b.c", "a{100}", "[ab]{200}", "a{0,300}b"})
+  {
+    auto const pattern = tokenize(text);
+    auto const flat = tokenize_flat(text);
+    Matcher const matcher{pattern};
+    Matcher const flat_matcher{flat};
+    for (auto const & string : {std::string{}, std::string{"aab"}, std::string{"axbxc"}, std::string(100, 'a'),
+                                std::string(200, 'b'), std::string(300, 'a') + "b", std::string(301, 'a') + "b"})
+    {
+      REQUIRE(matcher.matches(string) == matches(string, pattern));
+      REQUIRE(flat_matcher.matches(string) == matches(string, pattern));
+    }
+  }
+  REQUIRE(Matcher{tokenize("a{0,300}b")}.matches(std::string(300, 'a') + "b"));
+  REQUIRE(!Matcher{tokenize("a{0,300}b")}.matches(std::string(301, 'a') + "b"));
+}
+
 }
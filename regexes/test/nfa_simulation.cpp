@@ -0,0 +1,95 @@
+#include "compiled_pattern.hpp"
+#include "nfa_simulation.hpp"
+#include "shift_and.hpp"
+#include <catch2/catch.hpp>
+#include <string>
+#include <type_traits>
+
+namespace
+{
+using namespace regexes;
+
+TEST_CASE("NFA simulation agrees with DFA", "[NfaSimulation]")
+{
+  std::vector<std::string> inputs{""};
+  for (std::size_t i = 0; i < inputs.size(); ++i)
+    if (inputs[i].size() < 6)
+      for (char c : {'a', 'b', 'c'})
+        inputs.push_back(inputs[i] + c);
+
+  for (auto text : {"", "a", "a*", "a*a", "ab*c", "a*b*c*", ".*", ".a.", "[ab]*c", "a*a*a*b", "[bc].*[ab]*a",
+                    "a+b", "a?b?c", "[a-b]{2,3}", "[^a]+", "^a.$", "a{0,2}b{2,}", ".{3}c?"})
+  {
+    auto const pattern = tokenize(text);
+    NfaProgram const program{pattern};
+    NfaSimulation simulation{program};
+    CompiledPattern const dfa{pattern};
+    for (auto const & input : inputs)
+    {
+      INFO(text << " on " << input);
+      REQUIRE(simulation.matches(input) == dfa.matches(input));
+    }
+  }
+}
+
+TEST_CASE("NFA simulation can't outlive its program", "[NfaSimulation]")
+{
+  STATIC_REQUIRE(std::is_constructible_v<NfaSimulation, NfaProgram const &>);
+  STATIC_REQUIRE(!std::is_constructible_v<NfaSimulation, NfaProgram &&>);
+}
+
+TEST_CASE("NFA simulation counts bounded repetitions", "[NfaSimulation]")
+{
+  std::vector<std::string> inputs;
+  std::uint32_t seed = 1;
+  for (std::size_t i = 0; i < 2000; ++i)
+  {
+    std::string input;
+    for (auto length = i % 40; length > 0; --length)
+    {
+      seed = seed * 1103515245u + 12345u;
+      input += "aab"[(seed >> 16) % 3];
+    }
+    inputs.push_back(input);
+  }
+
+  for (auto text : {".*a{2,7}b?a{0,3}", "[ab]{5,}a", "a{0,4}[ab]*b{3}", "b*a{3}[ab]{0,2}", "[^b]{1,9}b{1,2}a{10,}"})
+  {
+    auto const pattern = tokenize(text);
+    NfaProgram const program{pattern};
+    NfaSimulation simulation{program};
+    ShiftAnd<256> const shift_and{pattern};
+    for (auto const & input : inputs)
+    {
+      INFO(text << " on " << input);
+      REQUIRE(simulation.matches(input) == shift_and.matches(input));
+    }
+  }
+
+  auto const pattern = tokenize(".*a{1,1000}b");
+  NfaProgram const program{pattern};
+  NfaSimulation simulation{program};
+  REQUIRE(simulation.matches(std::string(5000, 'a') + "b"));
+  REQUIRE(simulation.matches("b" + std::string(1000, 'a') + "b"));
+  REQUIRE(!simulation.matches("b" + std::string(1000, 'a') + "cb"));
+  REQUIRE(!simulation.matches("bb"));
+}
+
+TEST_CASE("NFA simulation keeps states deduplicated", "[NfaSimulation]")
+{
+  std::string text;
+  for (int i = 0; i < 200; ++i)
+    text += "a*";
+  auto const pattern = tokenize(text + "b");
+  NfaProgram const program{pattern};
+  // one state per starred token, two for the plain one, one final
+  REQUIRE(program.states() == 203);
+
+  NfaSimulation simulation{program};
+  std::string input(5000, 'a');
+  REQUIRE(!simulation.matches(input));
+  input.push_back('b');
+  REQUIRE(simulation.matches(input));
+}
+
+}
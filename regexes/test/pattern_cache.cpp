@@ -0,0 +1,90 @@
+#include "matcher.hpp"
+#include "pattern_cache.hpp"
+#include <catch2/catch.hpp>
+#include <thread>
+
+namespace
+{
+using namespace regexes;
+
+TEST_CASE("Pattern cache reuses tokenized patterns", "[PatternCache]")
+{
+  PatternCache cache{2};
+  auto const first = cache.get("a*b");
+  REQUIRE(first->size() == 2);
+  REQUIRE(cache.get("a*b") == first);
+  REQUIRE(cache.size() == 1);
+  auto const stats = cache.stats();
+  REQUIRE(stats.hits == 1);
+  REQUIRE(stats.misses == 1);
+  REQUIRE(stats.evictions == 0);
+}
+
+TEST_CASE("Pattern cache keeps a matcher with each pattern", "[PatternCache]")
+{
+  PatternCache cache{1};
+  auto const matcher = cache.matcher("a*b");
+  REQUIRE(matcher->matches("aab"));
+  REQUIRE(!matcher->matches("aba"));
+  REQUIRE(cache.matcher("a*b") == matcher);
+  REQUIRE(cache.get("a*b")->size() == 2);
+  REQUIRE(cache.size() == 1);
+  cache.get("b");
+  // evicted, still usable
+  REQUIRE(matcher->matches("b"));
+  REQUIRE(cache.stats().hits == 2);
+}
+
+TEST_CASE("Pattern cache evicts least recently used", "[PatternCache]")
+{
+  PatternCache cache{2};
+  auto const a = cache.get("a");
+  auto const b = cache.get("b");
+  REQUIRE(cache.get("a") == a);
+  cache.get("c"); // evicts b
+  REQUIRE(cache.size() == 2);
+  REQUIRE(cache.stats().evictions == 1);
+  REQUIRE(cache.get("a") == a);
+  REQUIRE(cache.get("b") != b);
+  REQUIRE(b->size() == 1); // still usable after eviction
+
+  cache.set_capacity(1);
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.stats().evictions == 3);
+
+  cache.set_capacity(0);
+  REQUIRE(cache.size() == 0);
+  REQUIRE(cache.get("a")->size() == 1);
+  REQUIRE(cache.size() == 0);
+}
+
+TEST_CASE("Pattern cache can be shared between threads", "[PatternCache]")
+{
+  PatternCache cache{4};
+  std::vector<std::thread> threads;
+  std::vector<int> matched(4, 0);
+  for (std::size_t t = 0; t < matched.size(); ++t)
+    threads.emplace_back([&cache, &matched, t] {
+      for (int i = 0; i < 1000; ++i)
+        for (auto text : {"a*b", "[ab]*", "x.y", "q", "z*"})
+          matched[t] += matches("aab", *cache.get(text));
+    });
+  for (auto & thread : threads)
+    thread.join();
+  for (auto count : matched)
+    REQUIRE(count == 2000);
+  auto const stats = cache.stats();
+  REQUIRE(stats.hits + stats.misses == 20000);
+}
+
+TEST_CASE("Matching pattern text goes through the default cache", "[PatternCache]")
+{
+  auto const before = default_pattern_cache().stats();
+  REQUIRE(matches("abc", "a.c"));
+  REQUIRE(matches("abc", "a.c"));
+  auto const after = default_pattern_cache().stats();
+  REQUIRE(after.hits + after.misses == before.hits + before.misses + 2);
+  REQUIRE(after.hits >= before.hits + 1);
+}
+
+}
@@ -0,0 +1,77 @@
+#include "matcher.hpp"
+#include "pattern_parser.hpp"
+#include <catch2/catch.hpp>
+#include <memory_resource>
+
+namespace
+{
+using namespace regexes;
+
+// forwards to another resource, counting allocations
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+  explicit CountingResource(std::pmr::memory_resource * upstream) : upstream(upstream) {}
+
+  std::size_t allocations = 0;
+  std::size_t deallocations = 0;
+
+private:
+  void * do_allocate(std::size_t bytes, std::size_t alignment) override
+  {
+    ++allocations;
+    return upstream->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void * pointer, std::size_t bytes, std::size_t alignment) override
+  {
+    ++deallocations;
+    upstream->deallocate(pointer, bytes, alignment);
+  }
+
+  bool do_is_equal(std::pmr::memory_resource const & other) const noexcept override
+  {
+    return this == &other;
+  }
+
+  std::pmr::memory_resource * upstream;
+};
+
+TEST_CASE("Tokenize allocates from the given resource", "[Tokenize]")
+{
+  CountingResource counting{std::pmr::new_delete_resource()};
+  {
+    auto const pattern = tokenize("a.b*[cd]{2,3}$", &counting);
+    REQUIRE(pattern.size() == 5);
+    // token array, an Impl per token, char and charset matchers and the
+    // counting policies, wildcard, anchor and other policies are shared
+    REQUIRE(counting.allocations == 1 + 5 + 3 + 2);
+    REQUIRE(matches("axbbbcdc", pattern));
+    REQUIRE(!matches("axbbbc", pattern));
+  }
+  REQUIRE(counting.deallocations == counting.allocations);
+}
+
+TEST_CASE("Pattern tokenized into an arena stays in it", "[Tokenize]")
+{
+  alignas(std::max_align_t) char buffer[16 * 1024];
+  std::pmr::monotonic_buffer_resource arena{buffer, sizeof(buffer), std::pmr::null_memory_resource()};
+  auto const pattern = tokenize("^[a-f0-9]+-x{2,5}.?[^q]*$", &arena);
+  auto const inside = [&](void const * pointer) {
+    return static_cast<char const *>(pointer) >= buffer && static_cast<char const *>(pointer) < buffer + sizeof(buffer);
+  };
+  REQUIRE(inside(pattern.data()));
+  REQUIRE(matches("c0ffee-xxxyz", pattern));
+  REQUIRE(!matches("c0ffee-xyz", pattern));
+
+  auto const copy = tokenize("^[a-f0-9]+-x{2,5}.?[^q]*$");
+  for (std::size_t i = 0; i < pattern.size(); ++i)
+  {
+    REQUIRE(pattern[i].accepted() == copy[i].accepted());
+    REQUIRE(pattern[i].min_matches() == copy[i].min_matches());
+    REQUIRE(pattern[i].max_matches() == copy[i].max_matches());
+    REQUIRE(pattern[i].anchor() == copy[i].anchor());
+  }
+}
+
+}
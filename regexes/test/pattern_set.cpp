@@ -0,0 +1,50 @@
+#include "matcher.hpp"
+#include "pattern_set.hpp"
+#include <catch2/catch.hpp>
+#include <string>
+
+namespace
+{
+using namespace regexes;
+
+TEST_CASE("Pattern set reports matching patterns", "[PatternSet]")
+{
+  PatternSet const set{{"a*", "ab", "[ab]*c", "", ".*b"}};
+  REQUIRE(set.size() == 5);
+  REQUIRE(set.matches("") == std::vector<bool>{true, false, false, true, false});
+  REQUIRE(set.matches("ab") == std::vector<bool>{false, true, false, false, true});
+  REQUIRE(set.matches("aaa") == std::vector<bool>{true, false, false, false, false});
+  REQUIRE(set.matches("babc") == std::vector<bool>{false, false, true, false, false});
+  REQUIRE(set.matches("xyz") == std::vector<bool>{false, false, false, false, false});
+}
+
+TEST_CASE("Pattern set agrees with matching patterns one by one", "[PatternSet]")
+{
+  std::vector<std::string> texts;
+  for (auto base : {"a*b", "[bc]*a*", "ab.", "a*a*a*", "c", ".*c.*", "b*a*c*b*"})
+    for (int i = 0; i < 20; ++i)
+      texts.push_back(std::string(static_cast<std::size_t>(i % 3), 'a') + base);
+  std::vector<std::string_view> const patterns(texts.cbegin(), texts.cend());
+  PatternSet const set{patterns};
+
+  std::vector<std::string> inputs{""};
+  for (std::size_t i = 0; i < inputs.size(); ++i)
+    if (inputs[i].size() < 5)
+      for (char c : {'a', 'b', 'c'})
+        inputs.push_back(inputs[i] + c);
+  std::vector<std::string_view> const input_views(inputs.cbegin(), inputs.cend());
+
+  auto const results = set.matches(input_views);
+  REQUIRE(results.size() == inputs.size());
+  for (std::size_t i = 0; i < inputs.size(); ++i)
+  {
+    REQUIRE(results[i] == set.matches(inputs[i]));
+    for (std::size_t p = 0; p < patterns.size(); ++p)
+    {
+      INFO(patterns[p] << " on " << inputs[i]);
+      REQUIRE(results[i][p] == matches(inputs[i], patterns[p]));
+    }
+  }
+}
+
+}
@@ -0,0 +1,67 @@
+#include "pattern_parser.hpp"
+#include "prefilter.hpp"
+#include <catch2/catch.hpp>
+#include <string>
+
+namespace
+{
+using namespace regexes;
+
+std::size_t reference_candidate(std::string_view string, std::size_t from, Prefilter const & prefilter)
+{
+  for (auto i = from; i < string.size(); ++i)
+    if (prefilter.first_byte_set()[static_cast<unsigned char>(string[i])] &&
+        string.substr(i, prefilter.literal_prefix().size()) == prefilter.literal_prefix())
+      return i;
+  return string.size();
+}
+
+TEST_CASE("Prefilter finds required prefix and first bytes", "[Prefilter]")
+{
+  Prefilter const literal{tokenize("abc*d")};
+  REQUIRE(literal.literal_prefix() == "ab");
+  REQUIRE(literal.first_byte_set() == ByteSet{}.set('a'));
+  REQUIRE(literal.may_match("ab"));
+  REQUIRE(!literal.may_match("ac"));
+  REQUIRE(!literal.may_match("a"));
+  REQUIRE(!literal.may_match(""));
+
+  Prefilter const starred{tokenize("a*[bc]d")};
+  REQUIRE(starred.literal_prefix().empty());
+  REQUIRE(starred.first_byte_set() == ByteSet{}.set('a').set('b').set('c'));
+  REQUIRE(starred.may_match("bd"));
+  REQUIRE(!starred.may_match("d"));
+
+  Prefilter const nullable{tokenize("a*b*")};
+  REQUIRE(nullable.may_match(""));
+  REQUIRE(!nullable.may_match("c"));
+
+  Prefilter const anchored{tokenize("^ab{2}c?$")};
+  REQUIRE(anchored.literal_prefix() == "abb");
+  REQUIRE(anchored.first_byte_set() == ByteSet{}.set('a'));
+
+  Prefilter const wildcard{tokenize(".x")};
+  REQUIRE(wildcard.first_byte_set().all());
+  REQUIRE(wildcard.may_match("zz"));
+}
+
+TEST_CASE("Prefilter skips to candidate positions", "[Prefilter]")
+{
+  std::string haystack(1000, 'z');
+  for (auto i : {3u, 17u, 40u, 63u, 64u, 100u, 517u, 998u})
+    haystack[i] = static_cast<char>('a' + i % 5);
+  haystack[300] = 'a';
+  haystack[301] = 'b';
+
+  for (auto text : {"a", "ab", "[ab]", "[abc]x", "[abcd]", "[abcde]", "a*b*c", ".", "z*q"})
+  {
+    Prefilter const prefilter{tokenize(text)};
+    for (std::size_t from = 0; from <= haystack.size(); from += 7)
+    {
+      INFO(text << " from " << from);
+      REQUIRE(prefilter.next_candidate(haystack, from) == reference_candidate(haystack, from, prefilter));
+    }
+  }
+}
+
+}
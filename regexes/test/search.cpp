@@ -0,0 +1,89 @@
+#include "matcher.hpp"
+#include "search.hpp"
+#include <catch2/catch.hpp>
+#include <string>
+
+namespace
+{
+using namespace regexes;
+
+// leftmost-longest match found by trying all substrings
+std::optional<Match> brute_force_find(std::string_view string, std::string_view pattern)
+{
+  for (std::size_t position = 0; position <= string.size(); ++position)
+    for (auto length = string.size() - position + 1; length > 0; --length)
+      if (matches(string.substr(position, length - 1), pattern))
+        return Match{position, length - 1};
+  return std::nullopt;
+}
+
+TEST_CASE("Find returns leftmost longest match", "[Search]")
+{
+  REQUIRE(find("xxabbby", tokenize("ab*")) == Match{2, 4});
+  REQUIRE(find("xxabbby", tokenize("b")) == Match{3, 1});
+  REQUIRE(find("xxabbby", tokenize("c")) == std::nullopt);
+  REQUIRE(find("xxabbby", tokenize("c*")) == Match{0, 0});
+  REQUIRE(find("", tokenize("")) == Match{0, 0});
+  REQUIRE(find("", tokenize("a")) == std::nullopt);
+  REQUIRE(find("aaab", tokenize("a*b")) == Match{0, 4});
+  REQUIRE(find("xaxab", tokenize("a.*b")) == Match{1, 4});
+}
+
+TEST_CASE("Find agrees with brute force", "[Search]")
+{
+  std::vector<std::string> inputs{""};
+  for (std::size_t i = 0; i < inputs.size(); ++i)
+    if (inputs[i].size() < 6)
+      for (char c : {'a', 'b', 'c'})
+        inputs.push_back(inputs[i] + c);
+
+  for (auto text : {"a", "ab", "a*b", "b*", "[ab]c", "a.c", "c.*a", "ba*b*c", "..b"})
+  {
+    auto const pattern = tokenize(text);
+    for (auto const & input : inputs)
+    {
+      INFO(text << " in " << input);
+      REQUIRE(find(input, pattern) == brute_force_find(input, text));
+    }
+  }
+}
+
+TEST_CASE("Find all iterates non-overlapping matches", "[Search]")
+{
+  auto const collect = [](std::string_view string, std::string_view pattern) {
+    auto const tokens = tokenize(pattern);
+    std::vector<Match> result;
+    for (auto const & match : find_all(string, tokens))
+      result.push_back(match);
+    return result;
+  };
+  REQUIRE(collect("abcabcab", "abc") == std::vector<Match>{{0, 3}, {3, 3}});
+  REQUIRE(collect("aXbbXb", "b*") == std::vector<Match>{{0, 0}, {1, 0}, {2, 2}, {4, 0}, {5, 1}, {6, 0}});
+  REQUIRE(collect("xyz", "a").empty());
+  REQUIRE(collect(std::string(1000, 'a'), "aa").size() == 500);
+  REQUIRE(collect("abab", "^ab") == std::vector<Match>{{0, 2}});
+  REQUIRE(collect("abab", "ab$") == std::vector<Match>{{2, 2}});
+  REQUIRE(collect("abc", "$") == std::vector<Match>{{3, 0}});
+}
+
+TEST_CASE("Find respects anchors", "[Search]")
+{
+  REQUIRE(find("abx", tokenize("^ab")) == Match{0, 2});
+  REQUIRE(find("xab", tokenize("^ab")) == std::nullopt);
+  REQUIRE(find("xab", tokenize("ab$")) == Match{1, 2});
+  REQUIRE(find("abx", tokenize("ab$")) == std::nullopt);
+  REQUIRE(find("abab", tokenize("^ab$")) == std::nullopt);
+  REQUIRE(find("aab", tokenize("^a*")) == Match{0, 2});
+  REQUIRE(find("baa", tokenize("a*$")) == Match{1, 2});
+  REQUIRE(find("xyz", tokenize("^")) == Match{0, 0});
+  REQUIRE(find("x^y", tokenize("x^")) == Match{0, 2});
+}
+
+TEST_CASE("Find handles bounded repetition", "[Search]")
+{
+  REQUIRE(find("xaaaaay", tokenize("a{2,3}")) == Match{1, 3});
+  REQUIRE(find("xab1234y", tokenize("[0-9]{3,}")) == Match{3, 4});
+  REQUIRE(find("ab", tokenize("[^a]?b")) == Match{1, 1});
+}
+
+}
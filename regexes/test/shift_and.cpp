@@ -0,0 +1,74 @@
+#include "compiled_pattern.hpp"
+#include "matcher.hpp"
+#include "shift_and.hpp"
+#include <catch2/catch.hpp>
+#include <string>
+
+namespace
+{
+using namespace regexes;
+
+// all strings over {a, b, c} of length up to max_length
+std::vector<std::string> small_inputs(std::size_t max_length)
+{
+  std::vector<std::string> result{""};
+  for (std::size_t i = 0; i < result.size(); ++i)
+    if (result[i].size() < max_length)
+      for (char c : {'a', 'b', 'c'})
+        result.push_back(result[i] + c);
+  return result;
+}
+
+template <std::size_t Bits>
+void require_same_as_dfa(std::string_view pattern_text)
+{
+  auto const pattern = tokenize(pattern_text);
+  REQUIRE(ShiftAnd<Bits>::fits(pattern));
+  ShiftAnd<Bits> const shift_and{pattern};
+  CompiledPattern const dfa{pattern};
+  for (auto const & input : small_inputs(6))
+  {
+    INFO(pattern_text << " on " << input);
+    REQUIRE(shift_and.matches(input) == dfa.matches(input));
+  }
+}
+
+TEST_CASE("Shift-And agrees with DFA", "[ShiftAnd]")
+{
+  for (auto pattern : {"", "a", "a*", "a*a", "ab*c", "a*b*c*", ".*", ".a.", "[ab]*c", "a*a*a*b", "[bc].*[ab]*a",
+                       "a+b", "a?b?c", "[a-b]{2,3}", "[^a]+", "^a.$", "a{0,2}b{2,}", ".{3}c?"})
+  {
+    require_same_as_dfa<64>(pattern);
+    require_same_as_dfa<128>(pattern);
+    require_same_as_dfa<256>(pattern);
+  }
+}
+
+TEST_CASE("Shift-And handles long patterns", "[ShiftAnd]")
+{
+  std::string stars;
+  for (int i = 0; i < 100; ++i)
+    stars += "a*";
+  auto const pattern = tokenize(stars + "b");
+  REQUIRE(!ShiftAnd<64>::fits(pattern));
+  REQUIRE(ShiftAnd<128>::fits(pattern));
+  ShiftAnd<128> const shift_and{pattern};
+  REQUIRE(shift_and.matches("b"));
+  REQUIRE(shift_and.matches(std::string(1000, 'a') + "b"));
+  REQUIRE(!shift_and.matches(std::string(1000, 'a')));
+
+  std::string const literal(200, 'x');
+  REQUIRE(!ShiftAnd<128>::fits(tokenize(literal)));
+  REQUIRE(ShiftAnd<256>{tokenize(literal)}.matches(literal));
+  REQUIRE(!ShiftAnd<256>{tokenize(literal)}.matches(literal + "x"));
+}
+
+TEST_CASE("Matching falls back for patterns not fitting the bit-parallel engine", "[ShiftAnd]")
+{
+  std::string const literal(300, 'x');
+  REQUIRE(matches(literal, literal));
+  REQUIRE(matches(literal, literal + "y*"));
+  REQUIRE(!matches(literal + "x", literal));
+}
+
+}
@@ -0,0 +1,90 @@
+#include "matcher.hpp"
+#include "static_pattern.hpp"
+#include <catch2/catch.hpp>
+#include <stdexcept>
+
+namespace
+{
+using namespace regexes;
+
+TEST_CASE("Static pattern matching works at compile time", "[StaticPattern]")
+{
+  SECTION("PARSING")
+  {
+    STATIC_REQUIRE(make_static_pattern("").size() == 0);
+    STATIC_REQUIRE(make_static_pattern("a*[bc].").size() == 3);
+    STATIC_REQUIRE(static_pattern<'a', '*', '[', 'b', 'c', ']', '.'>.size() == 3);
+  }
+  SECTION("MATCHING")
+  {
+    STATIC_REQUIRE(matches("", make_static_pattern("")));
+    STATIC_REQUIRE(matches("a", make_static_pattern("a")));
+    STATIC_REQUIRE(matches("ab", make_static_pattern("a.")));
+    STATIC_REQUIRE(matches("", make_static_pattern("a*")));
+    STATIC_REQUIRE(matches("aaaaa", make_static_pattern(".*")));
+    STATIC_REQUIRE(matches("aaabbaaabaaaaaaa", make_static_pattern("aa*aab*aaab.a*")));
+    STATIC_REQUIRE(matches("ba", make_static_pattern("[ab][ab]")));
+    STATIC_REQUIRE(matches("b", make_static_pattern("[ab][c]*")));
+    STATIC_REQUIRE(matches("aabx", static_pattern<'a', '*', '[', 'b', 'c', ']', '.'>));
+
+    STATIC_REQUIRE(!matches("", make_static_pattern("a*a")));
+    STATIC_REQUIRE(!matches("ab", make_static_pattern("aba")));
+    STATIC_REQUIRE(!matches("aaa", make_static_pattern("....")));
+    STATIC_REQUIRE(!matches("a", make_static_pattern("ab")));
+    STATIC_REQUIRE(!matches("ab", make_static_pattern("a")));
+    STATIC_REQUIRE(!matches("c", make_static_pattern("[ab]")));
+  }
+  SECTION("EXTENDED SYNTAX")
+  {
+    STATIC_REQUIRE(make_static_pattern("^a+b?$").size() == 2);
+    STATIC_REQUIRE(make_static_pattern("a{2,4}").size() == 4);
+    STATIC_REQUIRE(matches("aab", make_static_pattern("^a+b?$")));
+    STATIC_REQUIRE(matches("c7", make_static_pattern("[a-f][^a-z]")));
+    STATIC_REQUIRE(matches("aaa", make_static_pattern("a{2,4}")));
+    STATIC_REQUIRE(matches("aaaaa", make_static_pattern("a{2,}")));
+    STATIC_REQUIRE(!matches("aaaaa", make_static_pattern("a{2,4}")));
+    STATIC_REQUIRE(!matches("c", make_static_pattern("[^a-f]")));
+  }
+}
+
+TEST_CASE("Static pattern agrees with runtime matching", "[StaticPattern]")
+{
+  constexpr auto pattern = make_static_pattern("a*[bc].*c");
+  constexpr auto extended = make_static_pattern("^a?[b-c]{1,2}.+c$");
+  for (std::string_view input : {"", "c", "bc", "ac", "aabxc", "aaccc", "b", "aaab", "cxyzc", "abbxc", "abbbxc"})
+  {
+    REQUIRE(pattern.matches(input) == matches(input, "a*[bc].*c"));
+    REQUIRE(extended.matches(input) == matches(input, "^a?[b-c]{1,2}.+c$"));
+  }
+}
+
+TEST_CASE("Static pattern rejects repetitions beyond its size", "[StaticPattern]")
+{
+  char const fits[] = "a{4}";
+  REQUIRE(StaticPattern<sizeof(fits)>{fits}.size() == 4);
+  char const too_long[] = "a{9}";
+  REQUIRE_THROWS_AS(StaticPattern<sizeof(too_long)>{too_long}, std::length_error);
+  char const too_many_optional[] = "ab{0,9}";
+  REQUIRE_THROWS_AS(StaticPattern<sizeof(too_many_optional)>{too_many_optional}, std::length_error);
+}
+
+TEST_CASE("Static pattern braces with too large counts are plain chars", "[StaticPattern]")
+{
+  constexpr auto huge = make_static_pattern("a{1,1000000000}");
+  STATIC_REQUIRE(huge.matches("a{1,1000000000}"));
+  STATIC_REQUIRE(!huge.matches("aaa"));
+  REQUIRE(!matches("aaa", "a{1,1000000000}"));
+  REQUIRE(matches("a{1,1000000000}", "a{1,1000000000}"));
+  // would wrap around to a{1} counted in 64 bits
+  constexpr auto wrapping = make_static_pattern("a{18446744073709551617}");
+  STATIC_REQUIRE(!wrapping.matches("a"));
+  STATIC_REQUIRE(wrapping.matches("a{18446744073709551617}"));
+}
+
+TEST_CASE("Reversed ranges are rejected", "[StaticPattern]")
+{
+  char const reversed[] = "[z-a]";
+  REQUIRE_THROWS_AS(StaticPattern<sizeof(reversed)>{reversed}, std::invalid_argument);
+}
+
+}
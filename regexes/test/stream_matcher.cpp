@@ -0,0 +1,49 @@
+#include "matcher.hpp"
+#include "stream_matcher.hpp"
+#include <catch2/catch.hpp>
+#include <string>
+
+namespace
+{
+using namespace regexes;
+
+TEST_CASE("Stream matching agrees with matching whole input", "[StreamMatcher]")
+{
+  std::string long_pattern;
+  for (int i = 0; i < 150; ++i)
+    long_pattern += "a*b*";
+  for (auto text : {"", "a*", "ab*c", ".*c.", "[ab]*c*", long_pattern.c_str()})
+  {
+    auto const pattern = tokenize(text);
+    StreamMatcher matcher{pattern};
+    for (std::string input : {"", "a", "ac", "abbbc", "abcab", "aaaaaaaaaac", "cccc", "abababab"})
+    {
+      auto const expected = matches(input, pattern);
+      // every split of the input into three chunks
+      for (std::size_t first = 0; first <= input.size(); ++first)
+        for (auto second = first; second <= input.size(); ++second)
+        {
+          INFO(text << " on " << input << " split at " << first << ", " << second);
+          matcher.reset();
+          matcher.feed(input.substr(0, first));
+          matcher.feed(input.substr(first, second - first));
+          matcher.feed(input.substr(second));
+          REQUIRE(matcher.finish() == expected);
+        }
+    }
+  }
+}
+
+TEST_CASE("Stream matching handles long inputs", "[StreamMatcher]")
+{
+  StreamMatcher matcher{tokenize("x.*y")};
+  matcher.feed("x");
+  std::string const chunk(4096, 'z');
+  for (int i = 0; i < 256; ++i)
+    matcher.feed(chunk);
+  REQUIRE(!matcher.finish());
+  matcher.feed("y");
+  REQUIRE(matcher.finish());
+}
+
+}
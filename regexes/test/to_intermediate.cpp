@@ -1,5 +1,6 @@
 #include "to_intermediate.hpp"
 #include <catch2/catch.hpp>
+#include <stdexcept>
 #include <string>
 
 namespace
@@ -13,34 +14,95 @@ TEST_CASE("Token extraction works", "[Intermediate representation]")
   std::string_view pattern_view = pattern;
   SECTION("Char extraction")
   {
-    REQUIRE( TokenDescription{TokenType::Char, Modifier::None, 1} ==
+    REQUIRE( TokenDescription{TokenType::Char, Modifier::None, 1, {1, 1}} ==
         get_next_token(pattern_view.begin(), pattern_view.end()));
   }
   SECTION("Wildcard extraction")
   {
-    REQUIRE( TokenDescription{TokenType::Wildcard, Modifier::None, 1} ==
+    REQUIRE( TokenDescription{TokenType::Wildcard, Modifier::None, 1, {1, 1}} ==
         get_next_token(pattern_view.begin() + 3, pattern_view.end()));
   }
   SECTION("Char with star extraction")
   {
-    REQUIRE( TokenDescription{TokenType::Char, Modifier::Star, 2} ==
+    REQUIRE( TokenDescription{TokenType::Char, Modifier::Star, 2, {0, unbounded}} ==
         get_next_token(pattern_view.begin() + 5, pattern_view.end()));
   }
   SECTION("Wildcard with star extraction")
   {
-    REQUIRE( TokenDescription{TokenType::Wildcard, Modifier::Star, 2} ==
+    REQUIRE( TokenDescription{TokenType::Wildcard, Modifier::Star, 2, {0, unbounded}} ==
         get_next_token(pattern_view.begin() + 7, pattern_view.end()));
   }
   SECTION("Charset extraction")
   {
-    REQUIRE( TokenDescription{TokenType::Charset, Modifier::None, 7} ==
+    REQUIRE( TokenDescription{TokenType::Charset, Modifier::None, 7, {1, 1}} ==
         get_next_token(pattern_view.begin() + 9, pattern_view.end()));
   }
   SECTION("Charset with star extraction")
   {
-    REQUIRE( TokenDescription{TokenType::Charset, Modifier::Star, 5} ==
+    REQUIRE( TokenDescription{TokenType::Charset, Modifier::Star, 5, {0, unbounded}} ==
         get_next_token(pattern_view.begin() + 16, pattern_view.end()));
   }
 }
 
+TEST_CASE("Quantifier extraction works", "[Intermediate representation]")
+{
+  auto const next = [](std::string_view pattern) { return get_next_token(pattern.begin(), pattern.end(), true); };
+  REQUIRE(TokenDescription{TokenType::Char, Modifier::Plus, 2, {1, unbounded}} == next("a+b"));
+  REQUIRE(TokenDescription{TokenType::Wildcard, Modifier::Optional, 2, {0, 1}} == next(".?"));
+  REQUIRE(TokenDescription{TokenType::Char, Modifier::Repeat, 4, {3, 3}} == next("a{3}"));
+  REQUIRE(TokenDescription{TokenType::Charset, Modifier::Repeat, 8, {2, unbounded}} == next("[ab]{2,}"));
+  REQUIRE(TokenDescription{TokenType::Char, Modifier::Repeat, 9, {1, 1000}} == next("x{1,1000}"));
+  SECTION("Braces not forming a repetition are plain chars")
+  {
+    REQUIRE(TokenDescription{TokenType::Char, Modifier::None, 1, {1, 1}} == next("a{"));
+    REQUIRE(TokenDescription{TokenType::Char, Modifier::None, 1, {1, 1}} == next("a{,2}"));
+    REQUIRE(TokenDescription{TokenType::Char, Modifier::None, 1, {1, 1}} == next("a{3,2}"));
+    REQUIRE(TokenDescription{TokenType::Char, Modifier::None, 1, {1, 1}} == next("a{2x}"));
+    REQUIRE(TokenDescription{TokenType::Char, Modifier::Plus, 2, {1, unbounded}} == next("{+"));
+  }
+  SECTION("Counts are at most max_repetition")
+  {
+    REQUIRE(TokenDescription{TokenType::Char, Modifier::Repeat, 8, {1000, unbounded}} == next("a{1000,}"));
+    REQUIRE(TokenDescription{TokenType::Char, Modifier::None, 1, {1, 1}} == next("a{1001}"));
+    REQUIRE(TokenDescription{TokenType::Char, Modifier::None, 1, {1, 1}} == next("a{1,1000000000}"));
+    REQUIRE(TokenDescription{TokenType::Char, Modifier::None, 1, {1, 1}} == next("a{18446744073709551617}"));
+  }
+}
+
+TEST_CASE("Anchor extraction works", "[Intermediate representation]")
+{
+  std::string_view const pattern = "^a^$b$";
+  REQUIRE(TokenDescription{TokenType::Anchor, Modifier::None, 1, {0, 0}} ==
+      get_next_token(pattern.begin(), pattern.end(), true));
+  REQUIRE(TokenDescription{TokenType::Char, Modifier::None, 1, {1, 1}} ==
+      get_next_token(pattern.begin() + 2, pattern.end()));
+  REQUIRE(TokenDescription{TokenType::Char, Modifier::None, 1, {1, 1}} ==
+      get_next_token(pattern.begin() + 3, pattern.end()));
+  REQUIRE(TokenDescription{TokenType::Anchor, Modifier::None, 1, {0, 0}} ==
+      get_next_token(pattern.begin() + 5, pattern.end()));
+}
+
+TEST_CASE("Charset bytes extraction works", "[Intermediate representation]")
+{
+  auto const bytes = [](std::string_view charset) { return charset_bytes(charset.begin(), charset.end()); };
+  auto const of = [](std::string_view chars) {
+    ByteSet result;
+    for (auto c : chars)
+      result.set(static_cast<unsigned char>(c));
+    return result;
+  };
+  REQUIRE(bytes("[abc]") == of("abc"));
+  REQUIRE(bytes("[a-f]") == of("abcdef"));
+  REQUIRE(bytes("[0-3x-z]") == of("0123xyz"));
+  REQUIRE(bytes("[-a]") == of("-a"));
+  REQUIRE(bytes("[a-]") == of("a-"));
+  REQUIRE_THROWS_AS(bytes("[z-a]"), std::invalid_argument);
+  REQUIRE_THROWS_AS(bytes("[^0-9f-a]"), std::invalid_argument);
+  REQUIRE_THROWS_AS(tokenize("x[z-a]*"), std::invalid_argument);
+  REQUIRE(bytes("[a-a]") == of("a"));
+  REQUIRE(bytes("[^ab]") == ~of("ab"));
+  REQUIRE(bytes("[a^]") == of("a^"));
+  REQUIRE(bytes("[]") == ByteSet{});
+}
+
 }